@@ -0,0 +1,31 @@
+////////////////////////////////////////////////////////////////////
+//  Benchmarks of the BENCH build of mini22.c (make bench)        //
+//  The firmware writes the id to GPIOR1, then 1 to GPIOR0 at     //
+//  start and 2 at the end of each measurement, 0xFF when done.   //
+//  bench_sim counts the cycles in between under simavr.          //
+////////////////////////////////////////////////////////////////////
+#ifndef BENCH_H
+#define BENCH_H
+
+#define BENCH_EMPTY 0             //Overhead of the markers, subtracted
+#define BENCH_SET_FREQUENCY1 1
+#define BENCH_SET_FREQUENCY2 2
+#define BENCH_SHOW_FREQUENCY 3
+#define BENCH_SHOW_METER 4
+#define BENCH_LCD_CLS 5
+#define BENCH_INT2ASC 6
+#define BENCH_STORE_FREQUENCY 7
+#define BENCH_GET_TEMP 8
+#define BENCH_SHOW_ALL_DATA 9
+#define BENCH_COUNT 10
+
+#define BENCH_MARK_START 1
+#define BENCH_MARK_STOP 2
+#define BENCH_MARK_END 0xFF
+
+#ifdef BENCH_NAMES
+static const char *bench_name[BENCH_COUNT] = {"empty", "set_frequency1", "set_frequency2", "show_frequency", "show_meter",
+	                                          "lcd_cls", "int2asc", "store_frequency", "get_temp", "show_all_data"};
+#endif
+
+#endif
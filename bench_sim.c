@@ -0,0 +1,189 @@
+////////////////////////////////////////////////////////////////////
+//  Cycle counts of the BENCH build of mini22.c under simavr      //
+//  ATmega644P at 16 MHz, see bench.h for the marker protocol.    //
+//                                                                //
+//  Usage: bench_sim mini22_bench.elf bench.csv [ref.csv [tol%]]  //
+//  Writes name, min and max cycles and us of each benchmark to   //
+//  the CSV file. With a reference file, fails if a benchmark     //
+//  takes more than tol percent (default 2) more cycles, or if    //
+//  the file is missing or has no entry for a benchmark.          //
+////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_io.h>
+#define BENCH_NAMES
+#include "bench.h"
+
+#define MCU "atmega644p"
+#define CPU_HZ 16000000UL
+#define GPIOR0_ADR 0x3E           //Data space addresses
+#define GPIOR1_ADR 0x4A
+#define CYCLE_LIMIT (CPU_HZ * 60) //Give up after 60s of simulated time
+
+static unsigned char bench_id = 0;
+static avr_cycle_count_t t_start = 0;
+static unsigned long long cyc_min[BENCH_COUNT], cyc_max[BENCH_COUNT];
+static int runs[BENCH_COUNT];
+static int done = 0;
+
+static void id_write(struct avr_t *avr, avr_io_addr_t addr, uint8_t v, void *param)
+{
+	bench_id = v < BENCH_COUNT ? v : 0;
+}
+
+static void mark_write(struct avr_t *avr, avr_io_addr_t addr, uint8_t v, void *param)
+{
+	unsigned long long c;
+
+	switch(v)
+	{
+		case BENCH_MARK_START:
+		    t_start = avr->cycle;
+		    break;
+		case BENCH_MARK_STOP:
+		    c = avr->cycle - t_start;
+		    if(!runs[bench_id] || c < cyc_min[bench_id])
+		    {
+				cyc_min[bench_id] = c;
+			}
+		    if(c > cyc_max[bench_id])
+		    {
+				cyc_max[bench_id] = c;
+			}
+			runs[bench_id]++;
+		    break;
+		case BENCH_MARK_END:
+		    done = 1;
+		    break;
+	}
+}
+
+//Min cycles of benchmark in reference CSV to *r, 0 if not found
+static int ref_cycles(FILE *f, const char *name, unsigned long long *r)
+{
+	char line[128], n[64];
+	unsigned long long c;
+	int found = 0;
+
+	rewind(f);
+	while(fgets(line, sizeof(line), f))
+	{
+		if(sscanf(line, "%63[^,],%llu", n, &c) == 2 && !strcmp(n, name))
+		{
+			*r = c;
+			found = 1;
+		}
+	}
+	return found;
+}
+
+int main(int argc, char *argv[])
+{
+	elf_firmware_t fw;
+	avr_t *avr;
+	FILE *f, *fref = NULL;
+	int state, t1, fail = 0;
+	unsigned long long overhead, c, ref;
+	double tol = argc > 4 ? atof(argv[4]) : 2.0;
+
+	if(argc < 3)
+	{
+		fprintf(stderr, "usage: %s mini22_bench.elf bench.csv [ref.csv [tolerance %%]]\n", argv[0]);
+		return 2;
+	}
+	if(argc > 3)
+	{
+		fref = fopen(argv[3], "r");
+		if(!fref)
+		{
+			perror(argv[3]);
+			fprintf(stderr, "record a reference first (make bench_ref)\n");
+			return 2;
+		}
+	}
+
+	memset(&fw, 0, sizeof(fw));
+	if(elf_read_firmware(argv[1], &fw))
+	{
+		fprintf(stderr, "%s: cannot read\n", argv[1]);
+		return 2;
+	}
+	avr = avr_make_mcu_by_name(MCU);
+	if(!avr)
+	{
+		fprintf(stderr, "simavr: no %s\n", MCU);
+		return 2;
+	}
+	avr_init(avr);
+	fw.frequency = CPU_HZ;
+	avr_load_firmware(avr, &fw);
+	avr->frequency = CPU_HZ;
+
+	avr_register_io_write(avr, GPIOR1_ADR, id_write, NULL);
+	avr_register_io_write(avr, GPIOR0_ADR, mark_write, NULL);
+
+	do
+	{
+		state = avr_run(avr);
+	}
+	while(!done && state != cpu_Done && state != cpu_Crashed && avr->cycle < CYCLE_LIMIT);
+
+	if(!done)
+	{
+		fprintf(stderr, "%s: benchmark did not finish (state %d, %llu cycles)\n", argv[1], state, (unsigned long long) avr->cycle);
+		return 1;
+	}
+
+	f = fopen(argv[2], "w");
+	if(!f)
+	{
+		perror(argv[2]);
+		return 2;
+	}
+	fprintf(f, "name,cycles,cycles_max,us\n");
+	overhead = cyc_min[BENCH_EMPTY];
+	for(t1 = 1; t1 < BENCH_COUNT; t1++)
+	{
+		if(!runs[t1])
+		{
+			fprintf(stderr, "%s: not run\n", bench_name[t1]);
+			fail = 1;
+			continue;
+		}
+		c = cyc_min[t1] - overhead;
+		fprintf(f, "%s,%llu,%llu,%.1f\n", bench_name[t1], c, cyc_max[t1] - overhead, c * 1e6 / CPU_HZ);
+		printf("%-16s %10llu cycles %10.1f us", bench_name[t1], c, c * 1e6 / CPU_HZ);
+
+		if(fref)
+		{
+			if(!ref_cycles(fref, bench_name[t1], &ref))
+			{
+				printf("  NO REFERENCE");
+				fail = 1;
+			}
+			else
+			{
+				if(ref)
+				{
+					printf("  %+6.1f%%", (c - (double) ref) * 100.0 / ref);
+				}
+				if(c > ref * (1.0 + tol / 100.0))
+				{
+					printf("  REGRESSION");
+					fail = 1;
+				}
+			}
+		}
+		printf("\n");
+	}
+	fclose(f);
+	if(fref)
+	{
+		fclose(fref);
+	}
+
+	return fail;
+}
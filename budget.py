@@ -0,0 +1,192 @@
+#!/usr/bin/env python
+# Flash, RAM and stack budget of the Mini22 build.
+#
+# Section sizes are read from mini22.map, the stack usage of each function
+# from mini22.su and the call graph from mini22.ci (compiled with
+# -fstack-usage -fcallgraph-info=su, see Makefile). The worst case stack
+# depth is the deepest path from main plus the deepest interrupt handler,
+# interrupts do not nest in this firmware. The .su figures include the
+# return address, so a call adds nothing on top.
+#
+# Calls thru function pointer tables (task_func[], menu_action[][]) show up
+# as calls of __indirect_call. The possible targets are the functions named
+# in the __flash ..._fn tables the caller (or a function it calls and may
+# have inlined) uses in mini22.c, all of them if it uses none.
+#
+# Usage: python budget.py [--flash bytes] [--ram bytes] [--stack bytes] [--out mini22.stack]
+# Exit code 1 if a budget is exceeded, the graph has a cycle (recursion)
+# or a function uses a dynamic stack frame.
+import re
+import sys
+
+TARGET = "mini22"
+SRAM_SIZE = 4096      # ATmega644P
+FLASH_SIZE = 65536
+EXTERN_BYTES = 16     # Assumed for library functions without .su entry
+INDIRECT = "__indirect_call"
+
+
+def func_name(title):
+    # Static functions are "file:name", externals just "name"
+    return title.split(":")[-1]
+
+
+def read_su(fname):
+    frame = {}
+    dynamic = []
+    for line in open(fname):
+        f = line.rstrip("\n").split("\t")
+        if len(f) < 3:
+            continue
+        name = func_name(f[0])
+        frame[name] = int(f[1])
+        if f[2] != "static":
+            dynamic.append(name)
+    return frame, dynamic
+
+
+def read_ci(fname):
+    calls = {}
+    for m in re.finditer(r'edge: \{ sourcename: "([^"]*)" targetname: "([^"]*)"', open(fname).read()):
+        calls.setdefault(func_name(m.group(1)), set()).add(func_name(m.group(2)))
+    return calls
+
+
+def read_indirect(source):
+    # Function -> possible targets of its indirect calls: the entries of the
+    # tables used in its body, else in the bodies of the functions it calls
+    # (may be inlined). None for all tables.
+    src = open(source).read()
+    tables = {}
+    for m in re.finditer(r"__flash\s+\w+_fn\s+(\w+)(?:\[[^]]*\])+\s*=\s*\{(.*?)\};", src, re.S):
+        tables[m.group(1)] = set(re.findall(r"\w+", m.group(2)))
+    body = dict(re.findall(r"^\w[\w\s\*]*?\b(\w+)\([^;{]*\)\s*\n\{(.*?)^\}", src, re.S | re.M))
+
+    def used(name):
+        return [t for t in tables if re.search(r"\b%s\b" % t, body.get(name, ""))]
+
+    targets = {None: set().union(*tables.values())}
+    for name in body:
+        t = used(name)
+        if not t:
+            t = [u for c in re.findall(r"\b(\w+)\(", body[name]) if c != name for u in used(c)]
+        if t:
+            targets[name] = set().union(*(tables[u] for u in t))
+    return targets
+
+
+def read_map(fname):
+    size = {}
+    for line in open(fname):
+        m = re.match(r"^(\.text|\.data|\.bss|\.noinit|\.eeprom)\s+0x[0-9a-fA-F]+\s+0x([0-9a-fA-F]+)", line)
+        if m:
+            size[m.group(1)] = int(m.group(2), 16)
+    return size
+
+
+def is_isr(name):
+    return re.match(r"__vector_\d+$", name) or name.endswith("_vect")
+
+
+class Graph:
+    def __init__(self, frame, calls, indirect):
+        self.frame = frame
+        self.calls = calls
+        self.indirect = indirect
+        self.depth = {}
+        self.path = {}
+        self.cycles = []
+        self.externs = set()
+
+    def callees(self, name):
+        for c in self.calls.get(name, ()):
+            if c == INDIRECT:
+                for t in sorted(self.indirect.get(name, self.indirect[None])):
+                    yield t
+            else:
+                yield c
+
+    def walk(self, name, stack=()):
+        if name in self.depth:
+            return self.depth[name]
+        if name in stack:
+            self.cycles.append(stack[stack.index(name):] + (name,))
+            return 0
+        if name in self.frame:
+            own = self.frame[name]
+        else:
+            own = EXTERN_BYTES
+            self.externs.add(name)
+        best, best_path = 0, []
+        for c in self.callees(name):
+            d = self.walk(c, stack + (name,))
+            if d > best:
+                best, best_path = d, self.path.get(c, [c])
+        self.depth[name] = own + best
+        self.path[name] = [name] + best_path
+        return self.depth[name]
+
+
+def main(args):
+    opts = dict(zip(args[0::2], args[1::2]))
+    flash_budget = int(opts.get("--flash", FLASH_SIZE))
+    ram_budget = int(opts.get("--ram", SRAM_SIZE))
+    stack_budget = int(opts.get("--stack", SRAM_SIZE))
+    out = open(opts.get("--out", TARGET + ".stack"), "w")
+    fail = []
+
+    def emit(s=""):
+        print(s)
+        out.write(s + "\n")
+
+    frame, dynamic = read_su(TARGET + ".su")
+    g = Graph(frame, read_ci(TARGET + ".ci"), read_indirect(TARGET + ".c"))
+    isrs = sorted(n for n in frame if is_isr(n))
+    main_depth = g.walk("main")
+    isr_depth, isr_worst = 0, None
+    for n in isrs:
+        if g.walk(n) > isr_depth:
+            isr_depth, isr_worst = g.depth[n], n
+    stack = main_depth + isr_depth
+
+    size = read_map(TARGET + ".map")
+    flash = size.get(".text", 0) + size.get(".data", 0)
+    ram = size.get(".data", 0) + size.get(".bss", 0) + size.get(".noinit", 0)
+
+    emit("%-24s %6s %6s" % ("function", "frame", "depth"))
+    for n in sorted(frame, key=lambda n: (-g.depth.get(n, frame[n]), n)):
+        emit("%-24s %6d %6s" % (n, frame[n], g.depth.get(n, "-")))
+    emit()
+    emit("Worst path from main: %s" % " > ".join(g.path["main"]))
+    if isr_worst:
+        emit("Worst interrupt: %s" % " > ".join(g.path[isr_worst]))
+    if g.externs:
+        emit("No stack usage known, %d bytes assumed: %s" % (EXTERN_BYTES, " ".join(sorted(g.externs))))
+    emit()
+    emit("%-12s %6s %6s" % ("", "used", "budget"))
+    emit("%-12s %6d %6d" % ("flash", flash, flash_budget))
+    emit("%-12s %6d %6d  (.data %d .bss %d .noinit %d)" % ("ram", ram, ram_budget, size.get(".data", 0),
+                                                        size.get(".bss", 0), size.get(".noinit", 0)))
+    emit("%-12s %6d %6d  (main %d + interrupt %d)" % ("stack", stack, stack_budget, main_depth, isr_depth))
+    emit("%-12s %6d %6d" % ("ram + stack", ram + stack, SRAM_SIZE))
+    emit("%-12s %6d" % ("eeprom", size.get(".eeprom", 0)))
+    out.close()
+
+    if flash > flash_budget:
+        fail.append("flash %d > %d" % (flash, flash_budget))
+    if ram > ram_budget:
+        fail.append("ram %d > %d" % (ram, ram_budget))
+    if stack > stack_budget:
+        fail.append("stack %d > %d" % (stack, stack_budget))
+    if ram + stack > SRAM_SIZE:
+        fail.append("ram + stack %d > SRAM %d" % (ram + stack, SRAM_SIZE))
+    for c in g.cycles:
+        fail.append("recursion %s" % " > ".join(c))
+    for n in dynamic:
+        fail.append("dynamic stack frame in %s" % n)
+    if fail:
+        sys.exit("Budget exceeded: " + ", ".join(fail))
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
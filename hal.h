@@ -0,0 +1,148 @@
+////////////////////////////////////////////////////////////////////
+//  Hardware abstraction for mini22.c                             //
+//  AVR:  avr-libc and register macros, no overhead               //
+//  HOST: Linux simulation in hal_host.c (make host)              //
+////////////////////////////////////////////////////////////////////
+//  The firmware uses the avr-libc API for interrupts, sleep,     //
+//  EEPROM and delays, the host backend implements the same       //
+//  names. Register accesses go thru the hal_ macros below.       //
+////////////////////////////////////////////////////////////////////
+#ifndef HAL_H
+#define HAL_H
+
+#ifndef HOST
+//////////////////////////////////////////////////
+//   A V R
+//////////////////////////////////////////////////
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <avr/eeprom.h>
+#include <util/delay.h>
+#include <util/atomic.h>
+
+//GPIO, constant arguments compile to sbi/cbi/in/out
+#define hal_port_set(port, mask) ((port) |= (mask))
+#define hal_port_clr(port, mask) ((port) &= ~(mask))
+#define hal_port_write(port, val) ((port) = (val))
+#define hal_port_in(pin) (pin)
+
+//Rotary encoder on PD2 (INT0) and PD3 (INT1), any edge
+#define hal_enc_init() do { EICRA = (1 << ISC00) | (1 << ISC10); EIMSK = (1 << INT0) | (1 << INT1); } while(0)
+
+//Pin change interrupt on PORTD pins in mask (PCINT24..31)
+#define hal_pcint_init(mask) do { PCMSK3 = (mask); PCICR = (1 << PCIE3); } while(0)
+
+//Timer1 in CTC mode, prescaler 64, compare match A interrupt every top + 1 counts
+#define hal_clock_init(top) do { TCCR1A = 0; TCCR1B = (1 << WGM12) | (1 << CS11) | (1 << CS10); \
+                                 OCR1A = (top); TIMSK1 = (1 << OCIE1A); } while(0)
+#define hal_clock_count() TCNT1
+#define hal_clock_set_count(cnt) (TCNT1 = (cnt))
+#define hal_clock_pending() (TIFR1 & (1 << OCF1A))  //Compare match not yet serviced
+
+//ADC, Vref = VCC, prescaler 128, conversions triggered by Timer0 compare match A (CTC, prescaler 64)
+#define hal_adc_init(tick, ch) do { TCCR0A = (1 << WGM01); TCCR0B = (1 << CS01) | (1 << CS00); OCR0A = (tick); \
+                                    ADMUX = (1 << REFS0) + (ch); ADCSRB = (1 << ADTS1) | (1 << ADTS0); \
+                                    ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIE) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0); } while(0)
+#define hal_adc_value() ADC
+#define hal_adc_select(ch) (ADMUX = (1 << REFS0) + (ch))
+#define hal_adc_rearm() (TIFR0 = (1 << OCF0A))      //Clear trigger flag, next compare match starts next conversion
+#define hal_adc_halt() do { ADCSRA &= ~(1 << ADATE); while(ADCSRA & (1 << ADSC)); } while(0)
+#define hal_adc_resume() do { TIFR0 = (1 << OCF0A); ADCSRA |= (1 << ADATE); } while(0)
+
+//Benchmark build, markers for bench_sim and no interrupts meanwhile
+#define hal_bench_id(id) (GPIOR1 = (id))
+#define hal_bench_mark(m) (GPIOR0 = (m))
+#define hal_irq_sources_off() do { TIMSK1 = 0; ADCSRA = 0; EIMSK = 0; PCICR = 0; } while(0)
+
+#else
+//////////////////////////////////////////////////
+//   H O S T
+//////////////////////////////////////////////////
+#include <stdint.h>
+
+#define __flash
+
+//Port registers are numbers of simulated ports
+#define PORTA 0
+#define PORTB 1
+#define PORTC 2
+#define PORTD 3
+#define DDRA 4
+#define DDRB 5
+#define DDRC 6
+#define DDRD 7
+#define PINA 8
+#define PINB 9
+#define PINC 10
+#define PIND 11
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+
+//Interrupt handlers are plain functions called by the simulation
+#define ISR(vector, ...) void vector(void)
+#define ISR_ALIASOF(vector)
+void INT0_vect(void);
+void TIMER1_COMPA_vect(void);
+void PCINT3_vect(void);
+void ADC_vect(void);
+
+void cli(void);
+void sei(void);
+unsigned char hal_host_irq_save(void);
+void hal_host_irq_restore(unsigned char);
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_FORCEON 1
+#define ATOMIC_BLOCK(type) for(unsigned char hal_sreg = hal_host_irq_save(), hal_once = 1; hal_once; \
+                               hal_once = 0, hal_host_irq_restore((type) ? 1 : hal_sreg))
+
+#define SLEEP_MODE_IDLE 0
+#define SLEEP_MODE_ADC 1
+void set_sleep_mode(unsigned char);
+#define sleep_enable()
+#define sleep_disable()
+void sleep_cpu(void);
+
+void _delay_ms(double);
+void _delay_us(double);
+
+uint8_t eeprom_read_byte(const uint8_t*);
+uint16_t eeprom_read_word(const uint16_t*);
+void eeprom_write_byte(uint8_t*, uint8_t);
+void eeprom_update_byte(uint8_t*, uint8_t);
+void eeprom_write_word(uint16_t*, uint16_t);
+void eeprom_write_block(const void*, void*, unsigned int);
+#define eeprom_is_ready() 1
+
+void hal_host_port_set(int, unsigned char);
+void hal_host_port_clr(int, unsigned char);
+void hal_host_port_write(int, unsigned char);
+unsigned char hal_host_port_in(int);
+#define hal_port_set(port, mask) hal_host_port_set(port, mask)
+#define hal_port_clr(port, mask) hal_host_port_clr(port, mask)
+#define hal_port_write(port, val) hal_host_port_write(port, val)
+#define hal_port_in(pin) hal_host_port_in(pin)
+
+void hal_enc_init(void);
+void hal_pcint_init(unsigned char);
+
+void hal_clock_init(unsigned int);
+unsigned int hal_clock_count(void);
+void hal_clock_set_count(unsigned int);
+unsigned char hal_clock_pending(void);
+
+void hal_adc_init(unsigned char, unsigned char);
+int hal_adc_value(void);
+void hal_adc_select(unsigned char);
+void hal_adc_rearm(void);
+void hal_adc_halt(void);
+void hal_adc_resume(void);
+#endif
+
+#endif
@@ -0,0 +1,768 @@
+////////////////////////////////////////////////////////////////////
+//  Host backend of hal.h: runs mini22.c natively on Linux        //
+//  make host && MINI22_STIM=test.stim ./mini22_host              //
+////////////////////////////////////////////////////////////////////
+//  Simulated time is counted in CPU cycles at 16 MHz. It only    //
+//  advances in HAL calls (2 cycles per port access, 4 per        //
+//  atomic block), delays and sleep, code in between takes no     //
+//  time. Timer1 (ms clock), the Timer0 triggered ADC and the     //
+//  inputs of the stimulus file raise interrupts, they are        //
+//  serviced whenever interrupts are enabled.                     //
+//                                                                //
+//  Stimulus file, one event per line, times in ms from start:    //
+//  <ms> enc <steps> [ms between steps]  encoder, sign = direction //
+//  <ms> key <1..4> [hold ms]            front panel key          //
+//  <ms> adc <channel> <value>           analog input 0..1023     //
+//  <ms> ptt <0|1>                       level of PD0             //
+//  <ms> sb <0|1>                        level of PD1             //
+//  <ms> lcd                             print LCD to stdout      //
+//  <ms> quit                            stop (default: 1s after  //
+//                                       last event)              //
+//                                                                //
+//  Output on stdout: tuning words sent to DDS1 and DDS2 with     //
+//  their frequency, LCD screenshots and bus statistics at exit.  //
+//  EEPROM is kept in MINI22_EEP (default host.eep).              //
+////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hal.h"
+
+#define CPU_HZ 16000000UL
+#define CYCLES_MS (CPU_HZ / 1000)
+#define EEPROM_SIZE 2048
+#define STIM_MAX 4096
+
+//Board wiring, same as in mini22.c
+#define DDS1_IO_UD 1    //PB0
+#define DDS1_SDIO 2     //PB1
+#define DDS1_SCLK 4     //PB2
+#define DDS2_FSYNC 1    //PC0
+#define DDS2_SDATA 2    //PC1
+#define DDS2_SCLK 4     //PC2
+#define LCD_RES 16      //PD4
+#define LCD_DC 32       //PD5
+#define LCD_DN 64       //PD6
+#define LCD_SCLK 128    //PD7
+static const int key_adc[4] = {86, 31, 50, 38}; //ADC0 of keys 1..4, open: 1023
+
+//Time and interrupts
+static unsigned long long cycles = 0;
+static unsigned char irq_on = 0;
+static unsigned char in_isr = 0;
+static unsigned char sleep_mode = SLEEP_MODE_IDLE;
+static unsigned long isr_count = 0;
+
+//Ports, inputs of PIND are driven by the stimulus
+static unsigned char port[8];
+static unsigned char pind_in = 0x0F; //PD0 PTT off, PD1 USB, encoder at rest
+
+//Timer1 clock
+static unsigned char t1_on = 0;
+static unsigned int t1_top = 249;
+static unsigned long long t1_base;   //Cycle of count 0 in current period
+static unsigned char t1_flag = 0;
+
+//ADC
+static unsigned char adc_on = 0, adc_auto = 0, adc_busy = 0, adc_flag = 0;
+static unsigned int adc_period;      //Cycles between Timer0 triggers
+static unsigned long long adc_next;  //Next trigger
+static unsigned long long adc_done;  //End of running conversion
+static unsigned char adc_mux = 0, adc_conv_mux = 0;
+static int adc_in[8] = {1023, 614, 100, 0, 500, 0, 0, 0};
+static int adc_result = 0;
+
+//External interrupts
+static unsigned char enc_on = 0, enc_flag = 0;
+static unsigned char pcint_mask = 0, pcint_flag = 0;
+static int enc_pos = 2;                  //Gray code index, PD3:PD2 = 11 at rest
+
+//Stimulus, sorted by time. Encoder edges and key releases are inserted as "edge" and "keyup".
+struct stim
+{
+	unsigned long long at;
+	char cmd[8];
+	long a, b;
+};
+static struct stim stim[STIM_MAX];
+static int stim_n = 0, stim_pos = 0;
+static unsigned long long quit_at;
+
+//Bus capture
+static int dds1_bits = 0;
+static unsigned long long dds1_sr = 0;
+static unsigned long dds1_words = 0;
+static int dds2_bits = 0;
+static unsigned int dds2_sr = 0, dds2_lsb = 0;
+static unsigned char dds2_lsb_next = 1;
+static unsigned long dds2_words = 0;
+static int lcd_bits = 0;
+static unsigned char lcd_sr = 0;
+static unsigned char lcd_ext = 0;
+static int lcd_x = 0, lcd_y = 0;
+static unsigned char lcd_ram[6][84];
+static unsigned long lcd_bytes = 0;
+static unsigned long long bus_cycles = 0;
+
+//EEPROM
+static unsigned char eeprom[EEPROM_SIZE];
+static const char *eeprom_file = "host.eep";
+
+static void run(unsigned long long);
+
+static double now_ms(void)
+{
+	return cycles * 1000.0 / CPU_HZ;
+}
+
+  //////////////////////
+ //  Bus capture     //
+//////////////////////
+static void lcd_byte(unsigned char b, int data)
+{
+	lcd_bytes++;
+	if(data)
+	{
+		lcd_ram[lcd_y][lcd_x] = b;
+		if(++lcd_x >= 84)
+		{
+			lcd_x = 0;
+			lcd_y = (lcd_y + 1) % 6;
+		}
+		return;
+	}
+
+	if((b & 0xF8) == 0x20)  //Function set
+	{
+		lcd_ext = b & 1;
+	}
+	else if(!lcd_ext && (b & 0x80))
+	{
+		lcd_x = (b & 0x7F) % 84;
+	}
+	else if(!lcd_ext && (b & 0xF8) == 0x40)
+	{
+		lcd_y = (b & 7) % 6;
+	}
+}
+
+static void lcd_print(void)
+{
+	int x, y, bit;
+	unsigned char top, bottom;
+
+	printf("%10.3f LCD\n", now_ms());
+	for(y = 0; y < 6; y++)
+	{
+		for(bit = 0; bit < 8; bit += 2)
+		{
+			putchar('|');
+			for(x = 0; x < 84; x++)
+			{
+				top = (lcd_ram[y][x] >> bit) & 1;
+				bottom = (lcd_ram[y][x] >> (bit + 1)) & 1;
+				putchar(top ? (bottom ? ':' : '\'') : (bottom ? '.' : ' '));
+			}
+			puts("|");
+		}
+	}
+}
+
+//Decode bit banged buses on port writes
+static void bus_update(int p, unsigned char old, unsigned char val)
+{
+	unsigned char rise = ~old & val, fall = old & ~val;
+	unsigned long ftw;
+
+	switch(p)
+	{
+		case PORTB: //AD9951, SDIO sampled on rising SCLK, IO_UD rising ends transfer
+		    if(fall & DDS1_IO_UD)
+		    {
+				dds1_bits = 0;
+				dds1_sr = 0;
+			}
+			if((rise & DDS1_SCLK) && !(val & DDS1_IO_UD))
+			{
+				dds1_sr = (dds1_sr << 1) | ((val & DDS1_SDIO) ? 1 : 0);
+				dds1_bits++;
+			}
+			if((rise & DDS1_IO_UD) && dds1_bits == 40 && ((dds1_sr >> 32) & 0xFF) == 0x04)
+			{
+				ftw = dds1_sr & 0xFFFFFFFFUL;
+				dds1_words++;
+				printf("%10.3f DDS1 FTW %08lX %.1f Hz\n", now_ms(), ftw, ftw * 400e6 / 4294967296.0);
+			}
+			break;
+
+		case PORTC: //AD9834, SDATA sampled on falling SCLK while FSYNC is low
+		    if(fall & DDS2_FSYNC)
+		    {
+				dds2_bits = 0;
+				dds2_sr = 0;
+			}
+			if((fall & DDS2_SCLK) && !(val & DDS2_FSYNC))
+			{
+				dds2_sr = ((dds2_sr << 1) | ((val & DDS2_SDATA) ? 1 : 0)) & 0xFFFF;
+				dds2_bits++;
+			}
+			if((rise & DDS2_FSYNC) && dds2_bits == 16)
+			{
+				dds2_words++;
+				if((dds2_sr & 0xC000) == 0) //Control word, B28 set: LSBs, then MSBs follow
+				{
+					dds2_lsb_next = 1;
+				}
+				else if((dds2_sr & 0xC000) == 0x4000) //FREQ0
+				{
+					if(dds2_lsb_next)
+					{
+						dds2_lsb = dds2_sr & 0x3FFF;
+					}
+					else
+					{
+						ftw = ((unsigned long) (dds2_sr & 0x3FFF) << 14) | dds2_lsb;
+						printf("%10.3f DDS2 FTW %07lX %.1f Hz\n", now_ms(), ftw, ftw * 75e6 / 268435456.0);
+					}
+					dds2_lsb_next ^= 1;
+				}
+			}
+			break;
+
+		case PORTD: //PCD8544, DIN sampled on rising SCLK, D/C with last bit
+		    if(fall & LCD_RES)
+		    {
+				lcd_bits = 0;
+				lcd_ext = 0;
+			}
+			if(rise & LCD_SCLK)
+			{
+				lcd_sr = (lcd_sr << 1) | ((val & LCD_DN) ? 1 : 0);
+				if(++lcd_bits == 8)
+				{
+					lcd_byte(lcd_sr, val & LCD_DC);
+					lcd_bits = 0;
+				}
+			}
+			break;
+	}
+}
+
+  //////////////////////
+ //  GPIO            //
+//////////////////////
+static void port_write(int p, unsigned char val)
+{
+	unsigned char old = port[p];
+
+	port[p] = val;
+	if(p == PORTB || p == PORTC || p == PORTD)
+	{
+		bus_update(p, old, val);
+		bus_cycles += 2;
+	}
+	run(cycles + 2); //sbi/cbi/out
+}
+
+void hal_host_port_set(int p, unsigned char mask)
+{
+	port_write(p, port[p] | mask);
+}
+
+void hal_host_port_clr(int p, unsigned char mask)
+{
+	port_write(p, port[p] & ~mask);
+}
+
+void hal_host_port_write(int p, unsigned char val)
+{
+	port_write(p, val);
+}
+
+//Outputs read back as driven, inputs from the simulation
+unsigned char hal_host_port_in(int p)
+{
+	unsigned char in = 0;
+
+	if(p == PIND)
+	{
+		in = pind_in;
+	}
+	p -= PINA;
+	return (port[p] & port[p + DDRA]) | (in & ~port[p + DDRA]);
+}
+
+void hal_enc_init(void)
+{
+	enc_on = 1;
+}
+
+void hal_pcint_init(unsigned char mask)
+{
+	pcint_mask = mask;
+}
+
+  //////////////////////
+ //  Timer1 clock    //
+//////////////////////
+void hal_clock_init(unsigned int top)
+{
+	t1_top = top;
+	t1_base = cycles;
+	t1_on = 1;
+}
+
+unsigned int hal_clock_count(void)
+{
+	unsigned long long cnt = t1_on ? (cycles - t1_base) / 64 : 0;
+	
+	return cnt > t1_top ? cnt - t1_top - 1 : cnt;
+}
+
+void hal_clock_set_count(unsigned int cnt)
+{
+	t1_base = cycles - (unsigned long long) cnt * 64;
+}
+
+unsigned char hal_clock_pending(void)
+{
+	return t1_flag || (t1_on && cycles >= t1_base + (t1_top + 1) * 64ULL);
+}
+
+  //////////////////////
+ //  ADC             //
+//////////////////////
+void hal_adc_init(unsigned char tick, unsigned char ch)
+{
+	adc_period = (tick + 1) * 64;
+	adc_next = cycles + adc_period;
+	adc_mux = ch;
+	adc_on = 1;
+	adc_auto = 1;
+}
+
+int hal_adc_value(void)
+{
+	return adc_result;
+}
+
+void hal_adc_select(unsigned char ch)
+{
+	adc_mux = ch & 7;
+}
+
+void hal_adc_rearm(void)
+{
+}
+
+void hal_adc_halt(void)
+{
+	adc_auto = 0;
+	if(adc_busy)
+	{
+		run(adc_done);
+	}
+}
+
+void hal_adc_resume(void)
+{
+	adc_auto = 1;
+	adc_next = cycles + adc_period;
+}
+
+  //////////////////////
+ //  Interrupts      //
+//////////////////////
+static void stim_insert(unsigned long long at, const char *cmd, long a)
+{
+	int t1;
+
+	if(stim_n >= STIM_MAX)
+	{
+		return;
+	}
+	for(t1 = stim_n; t1 > stim_pos && stim[t1 - 1].at > at; t1--)
+	{
+		stim[t1] = stim[t1 - 1];
+	}
+	stim[t1].at = at;
+	strcpy(stim[t1].cmd, cmd);
+	stim[t1].a = a;
+	stim[t1].b = 0;
+	stim_n++;
+}
+
+static void encoder_edge(int dir)
+{
+	static const unsigned char gray[4] = {0, 1, 3, 2};
+
+	enc_pos += dir;
+	pind_in = (pind_in & ~0x0C) | (gray[enc_pos & 3] << 2);
+	enc_flag = enc_on;
+}
+
+static void set_pind(int bit, long level)
+{
+	unsigned char old = pind_in;
+
+	pind_in = level ? (pind_in | (1 << bit)) : (pind_in & ~(1 << bit));
+	if((old ^ pind_in) & pcint_mask)
+	{
+		pcint_flag = 1;
+	}
+}
+
+static void stim_apply(struct stim *s)
+{
+	int t1;
+
+	if(!strcmp(s->cmd, "enc")) //1 step = 2 edges 10us apart
+	{
+		for(t1 = 0; t1 < labs(s->a); t1++)
+		{
+			stim_insert(s->at + t1 * s->b * CYCLES_MS, "edge", s->a < 0 ? -1 : 1);
+			stim_insert(s->at + t1 * s->b * CYCLES_MS + 160, "edge", s->a < 0 ? -1 : 1);
+		}
+	}
+	else if(!strcmp(s->cmd, "edge"))
+	{
+		encoder_edge(s->a);
+	}
+	else if(!strcmp(s->cmd, "key") && s->a >= 1 && s->a <= 4)
+	{
+		adc_in[0] = key_adc[s->a - 1];
+		stim_insert(s->at + (s->b ? s->b : 100) * CYCLES_MS, "keyup", 0);
+	}
+	else if(!strcmp(s->cmd, "keyup"))
+	{
+		adc_in[0] = 1023;
+	}
+	else if(!strcmp(s->cmd, "adc") && s->a >= 0 && s->a < 8)
+	{
+		adc_in[s->a] = s->b;
+	}
+	else if(!strcmp(s->cmd, "ptt"))
+	{
+		set_pind(PD0, s->a);
+	}
+	else if(!strcmp(s->cmd, "sb"))
+	{
+		set_pind(PD1, s->a);
+	}
+	else if(!strcmp(s->cmd, "lcd"))
+	{
+		lcd_print();
+	}
+	else if(!strcmp(s->cmd, "quit"))
+	{
+		exit(0);
+	}
+	else
+	{
+		fprintf(stderr, "stimulus: unknown %s\n", s->cmd);
+	}
+}
+
+//Service pending interrupts in order of vector number
+static void service(void)
+{
+	while(irq_on && !in_isr && (enc_flag || pcint_flag || t1_flag || adc_flag))
+	{
+		in_isr = 1;
+		irq_on = 0;
+		if(enc_flag)
+		{
+			enc_flag = 0;
+			INT0_vect();
+		}
+		else if(pcint_flag)
+		{
+			pcint_flag = 0;
+			PCINT3_vect();
+		}
+		else if(t1_flag)
+		{
+			t1_flag = 0;
+			TIMER1_COMPA_vect();
+		}
+		else
+		{
+			adc_flag = 0;
+			ADC_vect();
+		}
+		irq_on = 1;
+		in_isr = 0;
+		isr_count++;
+	}
+}
+
+//Advance simulated time to cycle t, peripherals and stimulus raise interrupt flags on the way
+static void run(unsigned long long t)
+{
+	unsigned long long next;
+	struct stim s;
+
+	if(in_isr)
+	{
+		cycles = t > cycles ? t : cycles;
+		return;
+	}
+
+	for(;;)
+	{
+		next = t;
+		if(t1_on && t1_base + (t1_top + 1) * 64ULL < next)
+		{
+			next = t1_base + (t1_top + 1) * 64ULL;
+		}
+		if(adc_on && adc_busy && adc_done < next)
+		{
+			next = adc_done;
+		}
+		if(adc_on && adc_auto && !adc_busy && adc_next < next)
+		{
+			next = adc_next;
+		}
+		if(stim_pos < stim_n && stim[stim_pos].at < next)
+		{
+			next = stim[stim_pos].at;
+		}
+		if(quit_at < next)
+		{
+			exit(0);
+		}
+		if(next > cycles)
+		{
+			cycles = next;
+		}
+
+		if(t1_on && cycles >= t1_base + (t1_top + 1) * 64ULL)
+		{
+			t1_base += (t1_top + 1) * 64ULL;
+			t1_flag = 1;
+		}
+		if(adc_on && adc_busy && cycles >= adc_done)
+		{
+			adc_busy = 0;
+			adc_result = adc_in[adc_conv_mux];
+			adc_flag = 1;
+		}
+		if(adc_on && adc_auto && !adc_busy && cycles >= adc_next)
+		{
+			adc_busy = 1;
+			adc_conv_mux = adc_mux;
+			adc_done = cycles + 13 * 128;
+			adc_next += adc_period;
+		}
+		service();
+
+		if(stim_pos < stim_n && cycles >= stim[stim_pos].at)
+		{
+			s = stim[stim_pos++];
+			stim_apply(&s);
+			continue;
+		}
+		if(cycles >= t)
+		{
+			return;
+		}
+	}
+}
+
+void cli(void)
+{
+	irq_on = 0;
+}
+
+void sei(void)
+{
+	irq_on = 1;
+	if(!in_isr)
+	{
+		run(cycles + 1);
+	}
+}
+
+unsigned char hal_host_irq_save(void)
+{
+	unsigned char s = irq_on;
+
+	irq_on = 0;
+	return s;
+}
+
+void hal_host_irq_restore(unsigned char s)
+{
+	irq_on = s;
+	run(cycles + 4);
+}
+
+  //////////////////////
+ //  Sleep, delay    //
+//////////////////////
+void set_sleep_mode(unsigned char mode)
+{
+	sleep_mode = mode;
+}
+
+//Until next interrupt. In ADC noise reduction mode this starts a conversion and halts Timer1.
+void sleep_cpu(void)
+{
+	unsigned long long t0 = cycles;
+	unsigned long n = isr_count;
+
+	if(!irq_on)
+	{
+		return;
+	}
+	
+	if(sleep_mode == SLEEP_MODE_ADC && adc_on && !adc_busy)
+	{
+		adc_busy = 1;
+		adc_conv_mux = adc_mux;
+		adc_done = cycles + 13 * 128;
+		t1_on = 0;
+		run(adc_done);
+		t1_on = 1;
+		t1_base += cycles - t0;
+		return;
+	}
+
+	while(isr_count == n)
+	{
+		run(cycles + 16);
+	}
+}
+
+void _delay_ms(double ms)
+{
+	run(cycles + (unsigned long long) (ms * CYCLES_MS));
+}
+
+void _delay_us(double us)
+{
+	run(cycles + (unsigned long long) (us * CYCLES_MS / 1000));
+}
+
+  //////////////////////
+ //  EEPROM          //
+//////////////////////
+uint8_t eeprom_read_byte(const uint8_t *adr)
+{
+	return eeprom[(uintptr_t) adr % EEPROM_SIZE];
+}
+
+uint16_t eeprom_read_word(const uint16_t *adr)
+{
+	return eeprom_read_byte((const uint8_t*) adr) | (eeprom_read_byte((const uint8_t*) adr + 1) << 8);
+}
+
+//3.3ms per byte like the real one
+void eeprom_write_byte(uint8_t *adr, uint8_t val)
+{
+	eeprom[(uintptr_t) adr % EEPROM_SIZE] = val;
+	run(cycles + 3300 * (CYCLES_MS / 1000));
+}
+
+void eeprom_update_byte(uint8_t *adr, uint8_t val)
+{
+	if(eeprom_read_byte(adr) != val)
+	{
+		eeprom_write_byte(adr, val);
+	}
+}
+
+void eeprom_write_word(uint16_t *adr, uint16_t val)
+{
+	eeprom_update_byte((uint8_t*) adr, val & 0xFF);
+	eeprom_update_byte((uint8_t*) adr + 1, val >> 8);
+}
+
+void eeprom_write_block(const void *src, void *adr, unsigned int n)
+{
+	unsigned int t1;
+
+	for(t1 = 0; t1 < n; t1++)
+	{
+		eeprom_update_byte((uint8_t*) adr + t1, ((const uint8_t*) src)[t1]);
+	}
+}
+
+  //////////////////////
+ //  Startup, exit   //
+//////////////////////
+static int stim_cmp(const void *a, const void *b)
+{
+	const struct stim *x = a, *y = b;
+
+	return (x->at > y->at) - (x->at < y->at);
+}
+
+static void load_stimulus(const char *fname)
+{
+	FILE *f = fopen(fname, "r");
+	char line[128];
+	double ms;
+
+	if(!f)
+	{
+		perror(fname);
+		exit(1);
+	}
+	while(fgets(line, sizeof(line), f) && stim_n < STIM_MAX)
+	{
+		struct stim *s = &stim[stim_n];
+
+		s->a = s->b = 0;
+		if(line[0] == '#' || sscanf(line, "%lf %7s %ld %ld", &ms, s->cmd, &s->a, &s->b) < 2)
+		{
+			continue;
+		}
+		s->at = (unsigned long long) (ms * CYCLES_MS);
+		stim_n++;
+	}
+	fclose(f);
+	qsort(stim, stim_n, sizeof(struct stim), stim_cmp);
+}
+
+static void at_exit(void)
+{
+	FILE *f = fopen(eeprom_file, "wb");
+
+	if(f)
+	{
+		fwrite(eeprom, 1, EEPROM_SIZE, f);
+		fclose(f);
+	}
+	lcd_print();
+	printf("%10.3f END DDS1 %lu FTW, DDS2 %lu words, LCD %lu bytes, bus %.1f ms\n", now_ms(),
+	       dds1_words, dds2_words, lcd_bytes, bus_cycles * 1000.0 / CPU_HZ);
+}
+
+//Runs before main() of mini22.c
+__attribute__((constructor)) static void hal_host_setup(void)
+{
+	const char *s = getenv("MINI22_STIM");
+	FILE *f;
+
+	if(getenv("MINI22_EEP"))
+	{
+		eeprom_file = getenv("MINI22_EEP");
+	}
+	memset(eeprom, 0xFF, EEPROM_SIZE);
+	if((f = fopen(eeprom_file, "rb")))
+	{
+		if(fread(eeprom, 1, EEPROM_SIZE, f) != EEPROM_SIZE)
+		{
+			fprintf(stderr, "%s: short EEPROM image\n", eeprom_file);
+		}
+		fclose(f);
+	}
+
+	if(s)
+	{
+		load_stimulus(s);
+	}
+	quit_at = (stim_n ? stim[stim_n - 1].at : 0) + 1000 * CYCLES_MS;
+	atexit(at_exit);
+}
@@ -0,0 +1,12 @@
+//Generated by kty81.py - do not edit
+//KTY81-210 with RV = 5100 Ohms: ADC4 value -> PA temp. in 1/10 deg C
+#define KTY_ADC_MIN 160
+#define KTY_ADC_SHIFT 3
+#define KTY_TABLE_LEN 40
+static const __flash int kty81_table[KTY_TABLE_LEN] = {
+     -586,  -529,  -473,  -417,  -363,  -308,  -256,  -203,
+     -152,  -101,   -51,     0,    49,   100,   148,   198,
+      247,   296,   344,   394,   443,   492,   541,   591,
+      640,   689,   739,   789,   840,   891,   942,   993,
+     1045,  1099,  1155,  1213,  1278,  1355,  1452,  1571
+};
@@ -0,0 +1,133 @@
+#!/usr/bin/env python
+# Generates kty81.h: lookup table ADC4 value -> PA temperature
+# in 1/10 deg C for the KTY81-210 sensor of the Mini22.
+#
+# Sensor to GND, RV from +5V to ADC4, ADC reference = VCC, so
+# ADC = 1024 * Rt / (Rt + RV) independent of the supply voltage.
+#
+# Usage: python kty81.py > kty81.h
+#        python kty81.py --check [kty81_test]
+#
+# --check compares the table interpolation with the datasheet curve and
+# the former linear formula and fails if the error exceeds TOLERANCE.
+# With the kty81_test host program (make kty81_check) the values of the
+# C get_temp() are checked instead, over the whole ADC range.
+import subprocess
+import sys
+
+RV = 5100.0          # Divider resistor in Ohms
+ADC_MIN = 160        # 1st table entry (ADC value)
+ADC_SHIFT = 3        # Table step = 2^ADC_SHIFT ADC values
+ADC_STEPS = 40       # Number of table entries
+TOLERANCE = 1.0      # Max. error against the curve in deg C for --check
+
+# KTY81-210 typical resistance (Ohms) vs temperature (deg C), NXP datasheet
+CURVE = [(-55, 980), (-50, 1030), (-40, 1135), (-30, 1247), (-20, 1367),
+         (-10, 1495), (0, 1630), (10, 1772), (20, 1922), (25, 2000),
+         (30, 2080), (40, 2245), (50, 2417), (60, 2597), (70, 2785),
+         (80, 2980), (90, 3182), (100, 3392), (110, 3607), (120, 3817),
+         (125, 3915), (130, 4008), (140, 4166), (150, 4280)]
+
+
+def temp_of_r(r):
+    # Piecewise linear between datasheet points, extrapolated at both ends
+    for i in range(1, len(CURVE)):
+        if r <= CURVE[i][1] or i == len(CURVE) - 1:
+            t0, r0 = CURVE[i - 1]
+            t1, r1 = CURVE[i]
+            return t0 + (t1 - t0) * (r - r0) / float(r1 - r0)
+
+
+def r_of_adc(adc):
+    return RV * adc / (1024.0 - adc)
+
+
+def temp10_of_adc(adc):
+    return int(round(10 * temp_of_r(r_of_adc(adc))))
+
+
+def linear_temp10(adc):
+    # Former get_temp(): r0 = 1630 Ohms, slope 17.62 Ohms/K
+    return int(10 * ((r_of_adc(adc) - 1630) / 17.62))
+
+
+def table_lookup(table, adc):
+    # Same interpolation as get_temp() in mini22.c
+    step = 1 << ADC_SHIFT
+    adc_max = ADC_MIN + (ADC_STEPS - 1) * step
+    if adc <= ADC_MIN:
+        return table[0]
+    if adc >= adc_max:
+        return table[-1]
+    i = (adc - ADC_MIN) >> ADC_SHIFT
+    frac = (adc - ADC_MIN) & (step - 1)
+    return table[i] + (table[i + 1] - table[i]) * frac // step
+
+
+def make_table():
+    return [temp10_of_adc(ADC_MIN + (i << ADC_SHIFT)) for i in range(ADC_STEPS)]
+
+
+def write_header(table):
+    out = sys.stdout
+    out.write("//Generated by kty81.py - do not edit\n")
+    out.write("//KTY81-210 with RV = %d Ohms: ADC4 value -> PA temp. in 1/10 deg C\n" % RV)
+    out.write("#define KTY_ADC_MIN %d\n" % ADC_MIN)
+    out.write("#define KTY_ADC_SHIFT %d\n" % ADC_SHIFT)
+    out.write("#define KTY_TABLE_LEN %d\n" % ADC_STEPS)
+    out.write("static const __flash int kty81_table[KTY_TABLE_LEN] = {\n")
+    for i in range(0, ADC_STEPS, 8):
+        row = table[i:i + 8]
+        out.write("    " + ", ".join("%5d" % t for t in row))
+        out.write(",\n" if i + 8 < ADC_STEPS else "\n")
+    out.write("};\n")
+
+
+def run_test(prog):
+    # ADC value -> get_temp() as printed by kty81_test
+    out = subprocess.check_output([prog]).decode()
+    temps = {}
+    for line in out.splitlines():
+        f = line.split()
+        if len(f) == 2:
+            temps[int(f[0])] = int(f[1])
+    return temps
+
+
+def check(table, prog=None):
+    fail = 0
+    if prog:
+        temps = run_test(prog)
+        name = "C"
+        for adc in range(1024):
+            if temps.get(adc) != table_lookup(table, adc):
+                print("ADC %d: get_temp() %s, table %d" % (adc, temps.get(adc),
+                                                        table_lookup(table, adc)))
+                fail = 1
+    else:
+        temps = dict((adc, table_lookup(table, adc)) for adc in range(1024))
+        name = "table"
+
+    print(" ADC    Rt   curve  %5s  linear" % name)
+    worst = worst_linear = 0
+    for adc in range(ADC_MIN, ADC_MIN + (ADC_STEPS - 1 << ADC_SHIFT) + 1):
+        exact = 10 * temp_of_r(r_of_adc(adc))
+        worst = max(worst, abs(temps[adc] - exact))
+        worst_linear = max(worst_linear, abs(linear_temp10(adc) - exact))
+        if adc % 4 == 0:
+            print("%4d %5d %6.1f %6.1f %7.1f" % (adc, r_of_adc(adc), exact / 10,
+                                                 temps[adc] / 10.0, linear_temp10(adc) / 10.0))
+    print("Max. error of %s: %.2f deg C, of linear formula: %.2f deg C" % (
+        name, worst / 10, worst_linear / 10))
+    if worst / 10 > TOLERANCE:
+        print("FAIL: more than %.2f deg C" % TOLERANCE)
+        fail = 1
+    return fail
+
+
+if __name__ == "__main__":
+    if "--check" in sys.argv:
+        args = sys.argv[sys.argv.index("--check") + 1:]
+        sys.exit(check(make_table(), args[0] if args else None))
+    else:
+        write_header(make_table())
@@ -0,0 +1,27 @@
+////////////////////////////////////////////////////////////////////
+//  get_temp() of mini22.c over the whole ADC range, host build   //
+//  make kty81_check runs it and has kty81.py compare the         //
+//  result with the KTY81-210 curve and the former formula.       //
+//                                                                //
+//  Output: one line "adc temp" per ADC4 value, temp in 1/10 C.   //
+////////////////////////////////////////////////////////////////////
+#define main mini22_main
+#include "mini22.c"
+#undef main
+
+#include <unistd.h>
+
+int main(void)
+{
+	int adc;
+
+	for(adc = 0; adc < 1024; adc++)
+	{
+		adc_slot[4] = adc;
+		printf("%d %d\n", adc, get_temp());
+	}
+
+	//Leave without the exit report and EEPROM image of the simulator
+	fflush(stdout);
+	_exit(0);
+}
@@ -1,2702 +1,5760 @@
-////////////////////////////////////////////////////////////////////
-//     20m HiPerformance TRX with ATMega664P and AD9951 as VFO    //
-//            and AD9834 as LO, LCD: Nokia 5110                   //
-////////////////////////////////////////////////////////////////////
-//  Microcontroller:                                              //
-//  ATMEL AVR ATmega644P 16 MHz with ext. resonator               //
-//  EESAVE fuse activated, JTAG off                               //
-//  Fuses for ATMega644p: E:FF, H:D1, L:FF                        //
-//  -U lfuse:w:0xff:m -U hfuse:w:0xd1:m -U efuse:w:0xff:m         // 
-////////////////////////////////////////////////////////////////////
-//  Compiler:         GCC (GNU AVR C-Compiler)                    //
-//  Author:           Peter Rachow  DK7IH                         //
-//  Last Change: 2019-06-21                                       //
-////////////////////////////////////////////////////////////////////
-#include <inttypes.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <math.h>
-#include <avr/io.h>
-#include <avr/interrupt.h>
-#include <avr/sleep.h>
-#include <avr/eeprom.h>
-#include <util/delay.h>
-//////////////////////////////////////////////////
- 
-//Port usage  
-//O U T P U T 
-
-//DDS1
-//IO_UD:       PB0 (1) (green)  
-//SDIO (DATA): PB1 (2) (white)
-//SCLK         PB2 (4) (blue)
-//RESET        PB3     (violet)
- 
-//DDS2
-//FSYNC:       PC0 (1) (green)  
-//SDIO (DATA): PC1 (2) (white)
-//SCLK         PC2 (4) (blue)
-//RESET        PC3  (pink)
-
-//LCD
-//RES:  PD4
-//DC:   PD5
-//DIN:  PD6
-//SCLK: PD7
-
-// I N P U T
-//PD0: TX/RX detect
-//PD1 sideband switch
-//PD2, PD3: Rotary encoder
-
-//ADC
-//ADC Channels
-//PA0 - ADC0: 4 user keys in front panel
-//PA1 - ADC1: voltage measurement voltage divider
-//PA2 - ADC2: S-meter from AGC voltage
-//PA3 - ADC3: TX PWR meter
-//PA4 - ADC4: Temp. sensor PA
-
-//  EEPROM  //////////////////////////////////////////////////
-// Bytes
-// 0:63: Memory frequencies of MEM 0:15 in blocks by 4 bytes
-// 64:67: Freq VFO A memplace=16
-// 68:71: Freq VFO B memplace=17
-// 127: Last memory selected
-// 128: Last VFO in use
-// 129: Scan threshold (0:80)
-// 132:135: scanfreq[0] on memplace=33
-// 136:139: scanfreq[1] on memplace=34
-// 140:143: f_lo[0] on memplace=35
-// 144:147: f_lo[1] on memplace=36
-//////////////////////////////////////////////////////////////
-
-#define VOLTAGEFACTOR 4.6 //Const for voltage calculation
-
-#undef F_CPU
-#define F_CPU 16000000
-#define INTERFREQUENCY 9000000
-
-// SPI DDS1 (AD9951)
-#define DDS1_PORT PORTB
-#define DDS1_IO_UD 1      //PB0
-#define DDS1_SDIO 2       //PB1
-#define DDS1_SCLK 4       //PB2
-#define DDS1_RESETPIN 3   //PB3
-
-//  SPI DDS2 (AD9834)
-#define DDS2_PORT PORTC 
-#define DDS_FSYNC 1
-#define DDS_SDATA 2
-#define DDS_SCLK 4
-#define DDS2_RESETPIN 3
- 
-// PORT definitions Nokia 5110 LCD
-#define LCD_PORT PORTD
-#define RES 16       //PD4
-#define DC 32        //PD5
-#define DN 64        //PD6
-#define LCDSCLK 128  //PD7
-
-//LCD
-#define FONTWIDTH 6
-
-////////////////////////
-// F U N C T I O N S  //
-////////////////////////
-int main(void);
-
-//Menu
-long menux(long, int);
-void print_menu_head(char*, char*, int);
-void print_menu_item(char*, int, int);
-void print_menu_head(char*, char*, int);
-int navigate_thru_item_list(int, int);
-
-//Scanning & VFO
-long scan(int);
-void set_scan_threshold(void);
-long set_scan_frequency(int, long);
-int calc_tuningfactor(void);
-int set_vfo(int, int);
-
-//SPI for DDS1
-void spi1_send_bit1(int);
-void spi1_send_byte1(unsigned int);
-void spi1_send_word1(unsigned int);
-void set_frequency1(long);
-
-//SPI for DDS2
-void spi2_start(void);
-void spi2_send_bit(int);
-void spi2_stop(void);
-void set_frequency2(unsigned long);
-
-//LO setting
-void set_lo_freq(int);
-
-//STRING FUNCTIONS
-int int2asc(long, int, char*, int);
-int strlen(char *);
-
-//SPI for LCD
-void lcd_sendbyte(char, int);
-void lcd_senddata(char);
-void lcd_sendcmd(char);
-void lcd_reset(void);
-void lcd_gotoxy(char, char);
-void lcd_cleanram(void);
-int xp2(int);
-void lcd_putchar2(int, int, char, int);
-void lcd_putchar1(int, int, char, int);
-void lcd_putstring(int, int, char*, char, int);
-void lcd_putnumber(int, int, long, int, int, int);
-void lcd_init(void);
-void lcd_clearsection(int, int, int);
-void lcd_cls(int, int, int, int);
-void lcd_drawbox(int, int, int, int);
-
-//DATA DISPLAY ROUTINES
-void show_frequency(unsigned long);
-void show_frequency2(unsigned long);
-void show_voltage(int);
-void show_meter(int);
-void reset_smax(void);
-void show_sideband(int, int);
-void show_mem_addr(int, int);
-void show_mem_freq(unsigned long, int);
-void show_pa_temp(int);
-void show_vfo(int, int);
-void show_all_data(unsigned long, int, int, int, int, int);
-void show_meter_scale(int);
-
-//ADC
-//ADC Channels
-//ADC0: keys
-//ADC1: voltage
-int get_adc(int);
-int get_keys(void);
-int get_temp(void);
-
-//EEPROM and frequency storage
-#define MAXMEM 15
-void store_frequency(long, int);
-unsigned long load_frequency(int);
-int is_mem_freq_ok(unsigned long);
-void store_last_mem(int);
-int load_last_mem(void);
-void store_last_vfo(int);
-int load_last_vfo(void);
-void store_vfo_data(int, unsigned long, unsigned long);
-
-long recall_mem_freq(void);
-int save_mem_freq(long, int);
-
-//////////////////////////
-//   V A R I A B L E S
-//////////////////////////
-//Rotray encoder
-int tuningknob = 0;
-int tuningcount = 0;
-
-//Timer
-unsigned long runseconds10 = 0;
-
-//Tuning
-unsigned long f_vfo[2];
-int vfo_x, vfo_y;
-
-//LO settings
-long f_lo[] = {9000600, 8998200}; //USB, LSB
-int sideband = 0; //Sets sideband to USB	
-
-//MEMORY
-int last_memplace = 0;
-int last_mem = 0; //Stored in Byte ( 4 * 16 + 1) = 65
-
-//Scanning
-int s_threshold = 30;
-long scanfreq[2];
-
-//S-Meter max value
-int smax = 0;
-long runseconds10s = 0;
-
-// Font 6x8 for LCD Display Nokia 5110
-static const __flash char xchar[] = {
-0x00,0x00,0x00,0x00,0x00,0x00,	// 0x00
-0x00,0x3E,0x45,0x51,0x45,0x3E,	// 0x01
-0x00,0x3E,0x6B,0x6F,0x6B,0x3E,	// 0x02
-0x00,0x1C,0x3E,0x7C,0x3E,0x1C,	// 0x03
-0x00,0x18,0x3C,0x7E,0x3C,0x18,	// 0x04
-0x00,0x30,0x36,0x7F,0x36,0x30,	// 0x05
-0x00,0x18,0x5C,0x7E,0x5C,0x18,	// 0x06
-0x00,0x00,0x00,0x00,0x00,0x00,	// 0x07
-0x00,0x00,0x00,0x00,0x00,0x00,	// 0x08
-0x00,0x00,0x00,0x00,0x00,0x00,	// 0x09
-0x00,0x00,0x00,0x00,0x00,0x00,	// 0x0A
-0x00,0x30,0x48,0x4A,0x36,0x0E,	// 0x0B
-0x00,0x06,0x29,0x79,0x29,0x06,	// 0x0C
-0x00,0x00,0x00,0x00,0x00,0x00,	// 0x0D
-0x00,0x60,0x7E,0x0A,0x35,0x3F,	// 0x0E
-0x00,0x2A,0x1C,0x36,0x1C,0x2A,	// 0x0F
-0x00,0x00,0x7F,0x3E,0x1C,0x08,	// 0x10
-0x00,0x08,0x1C,0x3E,0x7F,0x00,	// 0x11
-0x00,0x14,0x36,0x7F,0x36,0x14,	// 0x12
-0x00,0x00,0x5F,0x00,0x5F,0x00,	// 0x13
-0x00,0x06,0x09,0x7F,0x01,0x7F,	// 0x14
-0x00,0x22,0x4D,0x55,0x59,0x22,	// 0x15
-0x00,0x60,0x60,0x60,0x60,0x00,	// 0x16
-0x00,0x14,0xB6,0xFF,0xB6,0x14,	// 0x17
-0x00,0x04,0x06,0x7F,0x06,0x04,	// 0x18
-0x00,0x10,0x30,0x7F,0x30,0x10,	// 0x19
-0x00,0x08,0x08,0x3E,0x1C,0x08,	// 0x1A
-0x00,0x08,0x1C,0x3E,0x08,0x08,	// 0x1B
-0x00,0x78,0x40,0x40,0x40,0x40,	// 0x1C
-0x00,0x08,0x3E,0x08,0x3E,0x08,	// 0x1D
-0x00,0x30,0x3C,0x3F,0x3C,0x30,	// 0x1E
-0x00,0x03,0x0F,0x3F,0x0F,0x03,	// 0x1F
-0x00,0x00,0x00,0x00,0x00,0x00,	// 0x20
-0x00,0x00,0x06,0x5F,0x06,0x00,	// 0x21
-0x00,0x07,0x03,0x00,0x07,0x03,	// 0x22
-0x00,0x24,0x7E,0x24,0x7E,0x24,	// 0x23
-0x00,0x24,0x2B,0x6A,0x12,0x00,	// 0x24
-0x00,0x63,0x13,0x08,0x64,0x63,	// 0x25
-0x00,0x36,0x49,0x56,0x20,0x50,	// 0x26
-0x00,0x00,0x07,0x03,0x00,0x00,	// 0x27
-0x00,0x00,0x3E,0x41,0x00,0x00,	// 0x28
-0x00,0x00,0x41,0x3E,0x00,0x00,	// 0x29
-0x00,0x08,0x3E,0x1C,0x3E,0x08,	// 0x2A
-0x00,0x08,0x08,0x3E,0x08,0x08,	// 0x2B
-0x00,0x00,0xE0,0x60,0x00,0x00,	// 0x2C
-0x00,0x08,0x08,0x08,0x08,0x08,	// 0x2D
-0x00,0x00,0x60,0x60,0x00,0x00,	// 0x2E
-0x00,0x20,0x10,0x08,0x04,0x02,	// 0x2F
-0x00,0x3E,0x41,0x49,0x41,0x3E,	// 0x30
-0x00,0x00,0x42,0x7F,0x40,0x00,	// 0x31
-0x00,0x62,0x51,0x49,0x49,0x46,	// 0x32
-0x00,0x22,0x49,0x49,0x49,0x36,	// 0x33
-0x00,0x18,0x14,0x12,0x7F,0x10,	// 0x34
-0x00,0x2F,0x49,0x49,0x49,0x31,	// 0x35
-0x00,0x3C,0x4A,0x49,0x49,0x30,	// 0x36
-0x00,0x01,0x71,0x09,0x05,0x03,	// 0x37
-0x00,0x36,0x49,0x49,0x49,0x36,	// 0x38
-0x00,0x06,0x49,0x49,0x29,0x1E,	// 0x39
-0x00,0x00,0x6C,0x6C,0x00,0x00,	// 0x3A
-0x00,0x00,0xEC,0x6C,0x00,0x00,	// 0x3B
-0x00,0x08,0x14,0x22,0x41,0x00,	// 0x3C
-0x00,0x24,0x24,0x24,0x24,0x24,	// 0x3D
-0x00,0x00,0x41,0x22,0x14,0x08,	// 0x3E
-0x00,0x02,0x01,0x59,0x09,0x06,	// 0x3F
-0x00,0x3E,0x41,0x5D,0x55,0x1E,	// 0x40
-0x00,0x7E,0x11,0x11,0x11,0x7E,	// 0x41
-0x00,0x7F,0x49,0x49,0x49,0x36,	// 0x42
-0x00,0x3E,0x41,0x41,0x41,0x22,	// 0x43
-0x00,0x7F,0x41,0x41,0x41,0x3E,	// 0x44
-0x00,0x7F,0x49,0x49,0x49,0x41,	// 0x45
-0x00,0x7F,0x09,0x09,0x09,0x01,	// 0x46
-0x00,0x3E,0x41,0x49,0x49,0x7A,	// 0x47
-0x00,0x7F,0x08,0x08,0x08,0x7F,	// 0x48
-0x00,0x00,0x41,0x7F,0x41,0x00,	// 0x49
-0x00,0x30,0x40,0x40,0x40,0x3F,	// 0x4A
-0x00,0x7F,0x08,0x14,0x22,0x41,	// 0x4B
-0x00,0x7F,0x40,0x40,0x40,0x40,	// 0x4C
-0x00,0x7F,0x02,0x04,0x02,0x7F,	// 0x4D
-0x00,0x7F,0x02,0x04,0x08,0x7F,	// 0x4E
-0x00,0x3E,0x41,0x41,0x41,0x3E,	// 0x4F
-0x00,0x7F,0x09,0x09,0x09,0x06,	// 0x50
-0x00,0x3E,0x41,0x51,0x21,0x5E,	// 0x51
-0x00,0x7F,0x09,0x09,0x19,0x66,	// 0x52
-0x00,0x26,0x49,0x49,0x49,0x32,	// 0x53
-0x00,0x01,0x01,0x7F,0x01,0x01,	// 0x54
-0x00,0x3F,0x40,0x40,0x40,0x3F,	// 0x55
-0x00,0x1F,0x20,0x40,0x20,0x1F,	// 0x56
-0x00,0x3F,0x40,0x3C,0x40,0x3F,	// 0x57
-0x00,0x63,0x14,0x08,0x14,0x63,	// 0x58
-0x00,0x07,0x08,0x70,0x08,0x07,	// 0x59
-0x00,0x71,0x49,0x45,0x43,0x00,	// 0x5A
-0x00,0x00,0x7F,0x41,0x41,0x00,	// 0x5B
-0x00,0x02,0x04,0x08,0x10,0x20,	// 0x5C
-0x00,0x00,0x41,0x41,0x7F,0x00,	// 0x5D
-0x00,0x04,0x02,0x01,0x02,0x04,	// 0x5E
-0x80,0x80,0x80,0x80,0x80,0x80,	// 0x5F
-0x00,0x00,0x03,0x07,0x00,0x00,	// 0x60
-0x00,0x20,0x54,0x54,0x54,0x78,	// 0x61
-0x00,0x7F,0x44,0x44,0x44,0x38,	// 0x62
-0x00,0x38,0x44,0x44,0x44,0x28,	// 0x63
-0x00,0x38,0x44,0x44,0x44,0x7F,	// 0x64
-0x00,0x38,0x54,0x54,0x54,0x08,	// 0x65
-0x00,0x08,0x7E,0x09,0x09,0x00,	// 0x66
-0x00,0x18,0xA4,0xA4,0xA4,0x7C,	// 0x67
-0x00,0x7F,0x04,0x04,0x78,0x00,	// 0x68
-0x00,0x00,0x00,0x7D,0x40,0x00,	// 0x69
-0x00,0x40,0x80,0x84,0x7D,0x00,	// 0x6A
-0x00,0x7F,0x10,0x28,0x44,0x00,	// 0x6B
-0x00,0x00,0x00,0x7F,0x40,0x00,	// 0x6C
-0x00,0x7C,0x04,0x18,0x04,0x78,	// 0x6D
-0x00,0x7C,0x04,0x04,0x78,0x00,	// 0x6E
-0x00,0x38,0x44,0x44,0x44,0x38,	// 0x6F
-0x00,0xFC,0x44,0x44,0x44,0x38,	// 0x70
-0x00,0x38,0x44,0x44,0x44,0xFC,	// 0x71
-0x00,0x44,0x78,0x44,0x04,0x08,	// 0x72
-0x00,0x08,0x54,0x54,0x54,0x20,	// 0x73
-0x00,0x04,0x3E,0x44,0x24,0x00,	// 0x74
-0x00,0x3C,0x40,0x20,0x7C,0x00,	// 0x75
-0x00,0x1C,0x20,0x40,0x20,0x1C,	// 0x76
-0x00,0x3C,0x60,0x30,0x60,0x3C,	// 0x77
-0x00,0x6C,0x10,0x10,0x6C,0x00,	// 0x78
-0x00,0x9C,0xA0,0x60,0x3C,0x00,	// 0x79
-0x00,0x64,0x54,0x54,0x4C,0x00,	// 0x7A
-0x00,0x08,0x3E,0x41,0x41,0x00,	// 0x7B
-0x00,0x00,0x00,0x77,0x00,0x00,	// 0x7C
-0x00,0x00,0x41,0x41,0x3E,0x08,	// 0x7D
-0x00,0x02,0x01,0x02,0x01,0x00,	// 0x7E
-0x00,0x3C,0x26,0x23,0x26,0x3C,	// 0x7F
-0x00,0x1E,0xA1,0xE1,0x21,0x12,	// 0x80
-0x00,0x3D,0x40,0x20,0x7D,0x00,	// 0x81
-0x00,0x38,0x54,0x54,0x55,0x09,	// 0x82
-0x00,0x20,0x55,0x55,0x55,0x78,	// 0x83
-0x00,0x20,0x55,0x54,0x55,0x78,	// 0x84
-0x00,0x20,0x55,0x55,0x54,0x78,	// 0x85
-0x00,0x20,0x57,0x55,0x57,0x78,	// 0x86
-0x00,0x1C,0xA2,0xE2,0x22,0x14,	// 0x87
-0x00,0x38,0x55,0x55,0x55,0x08,	// 0x88
-0x00,0x38,0x55,0x54,0x55,0x08,	// 0x89
-0x00,0x38,0x55,0x55,0x54,0x08,	// 0x8A
-0x00,0x00,0x01,0x7C,0x41,0x00,	// 0x8B
-0x00,0x00,0x01,0x7D,0x41,0x00,	// 0x8C
-0x00,0x00,0x01,0x7C,0x40,0x00,	// 0x8D
-0x00,0x70,0x29,0x24,0x29,0x70,	// 0x8E
-0x00,0x78,0x2F,0x25,0x2F,0x78,	// 0x8F
-0x00,0x7C,0x54,0x54,0x55,0x45,	// 0x90
-0x00,0x34,0x54,0x7C,0x54,0x58,	// 0x91
-0x00,0x7E,0x09,0x7F,0x49,0x49,	// 0x92
-0x00,0x38,0x45,0x45,0x39,0x00,	// 0x93
-0x00,0x38,0x45,0x44,0x39,0x00,	// 0x94
-0x00,0x39,0x45,0x44,0x38,0x00,	// 0x95
-0x00,0x3C,0x41,0x21,0x7D,0x00,	// 0x96
-0x00,0x3D,0x41,0x20,0x7C,0x00,	// 0x97
-0x00,0x9C,0xA1,0x60,0x3D,0x00,	// 0x98
-0x00,0x3D,0x42,0x42,0x3D,0x00,	// 0x99
-0x00,0x3C,0x41,0x40,0x3D,0x00,	// 0x9A
-0x80,0x70,0x68,0x58,0x38,0x04,	// 0x9B
-0x00,0x48,0x3E,0x49,0x49,0x62,	// 0x9C
-0x00,0x7E,0x61,0x5D,0x43,0x3F,	// 0x9D
-0x00,0x22,0x14,0x08,0x14,0x22,	// 0x9E
-0x00,0x40,0x88,0x7E,0x09,0x02,	// 0x9F
-0x00,0x20,0x54,0x55,0x55,0x78,	// 0xA0
-0x00,0x00,0x00,0x7D,0x41,0x00,	// 0xA1
-0x00,0x38,0x44,0x45,0x39,0x00,	// 0xA2
-0x00,0x3C,0x40,0x21,0x7D,0x00,	// 0xA3
-0x00,0x7A,0x09,0x0A,0x71,0x00,	// 0xA4
-0x00,0x7A,0x11,0x22,0x79,0x00,	// 0xA5
-0x00,0x08,0x55,0x55,0x55,0x5E,	// 0xA6
-0x00,0x4E,0x51,0x51,0x4E,0x00,	// 0xA7
-0x00,0x30,0x48,0x4D,0x40,0x20,	// 0xA8
-0x3E,0x41,0x5D,0x4B,0x55,0x3E,	// 0xA9
-0x04,0x04,0x04,0x04,0x04,0x1C,	// 0xAA
-0x00,0x17,0x08,0x4C,0x6A,0x50,	// 0xAB
-0x00,0x17,0x08,0x34,0x2A,0x78,	// 0xAC
-0x00,0x00,0x30,0x7D,0x30,0x00,	// 0xAD
-0x00,0x08,0x14,0x00,0x08,0x14,	// 0xAE
-0x00,0x14,0x08,0x00,0x14,0x08,	// 0xAF
-0x44,0x11,0x44,0x11,0x44,0x11,	// 0xB0
-0xAA,0x55,0xAA,0x55,0xAA,0x55,	// 0xB1
-0xBB,0xEE,0xBB,0xEE,0xBB,0xEE,	// 0xB2
-0x00,0x00,0x00,0xFF,0x00,0x00,	// 0xB3
-0x08,0x08,0x08,0xFF,0x00,0x00,	// 0xB4
-0x00,0x70,0x28,0x25,0x29,0x70,	// 0xB5
-0x00,0x70,0x29,0x25,0x29,0x70,	// 0xB6
-0x00,0x70,0x29,0x25,0x28,0x70,	// 0xB7
-0x3E,0x41,0x5D,0x55,0x41,0x3E,	// 0xB8
-0x0A,0xFB,0x00,0xFF,0x00,0x00,	// 0xB9
-0x00,0xFF,0x00,0xFF,0x00,0x00,	// 0xBA
-0x0A,0xFA,0x02,0xFE,0x00,0x00,	// 0xBB
-0x0A,0x0B,0x08,0x0F,0x00,0x00,	// 0xBC
-0x00,0x18,0x24,0x66,0x24,0x00,	// 0xBD
-0x00,0x29,0x2A,0x7C,0x2A,0x29,	// 0xBE
-0x08,0x08,0x08,0xF8,0x00,0x00,	// 0xBF
-0x00,0x00,0x00,0x0F,0x08,0x08,	// 0xC0
-0x08,0x08,0x08,0x0F,0x08,0x08,	// 0xC1
-0x08,0x08,0x08,0xF8,0x08,0x08,	// 0xC2
-0x00,0x00,0x00,0xFF,0x08,0x08,	// 0xC3
-0x08,0x08,0x08,0x08,0x08,0x08,	// 0xC4
-0x08,0x08,0x08,0xFF,0x08,0x08,	// 0xC5
-0x00,0x20,0x56,0x55,0x56,0x79,	// 0xC6
-0x00,0x70,0x2A,0x25,0x2A,0x71,	// 0xC7
-0x00,0x0F,0x08,0x0B,0x0A,0x0A,	// 0xC8
-0x00,0xFE,0x02,0xFA,0x0A,0x0A,	// 0xC9
-0x0A,0x0B,0x08,0x0B,0x0A,0x0A,	// 0xCA
-0x0A,0xFA,0x02,0xFA,0x0A,0x0A,	// 0xCB
-0x00,0xFF,0x00,0xFB,0x0A,0x0A,	// 0xCC
-0x0A,0x0A,0x0A,0x0A,0x0A,0x0A,	// 0xCD
-0x0A,0xFB,0x00,0xFB,0x0A,0x0A,	// 0xCE
-0x00,0x5D,0x22,0x22,0x22,0x5D,	// 0xCF
-0x00,0x22,0x55,0x59,0x30,0x00,	// 0xD0
-0x00,0x08,0x7F,0x49,0x41,0x3E,	// 0xD1
-0x00,0x7C,0x55,0x55,0x55,0x44,	// 0xD2
-0x00,0x7C,0x55,0x54,0x55,0x44,	// 0xD3
-0x00,0x7C,0x55,0x55,0x54,0x44,	// 0xD4
-0x00,0x00,0x00,0x07,0x00,0x00,	// 0xD5
-0x00,0x00,0x44,0x7D,0x45,0x00,	// 0xD6
-0x00,0x00,0x45,0x7D,0x45,0x00,	// 0xD7
-0x00,0x00,0x45,0x7C,0x45,0x00,	// 0xD8
-0x08,0x08,0x08,0x0F,0x00,0x00,	// 0xD9
-0x00,0x00,0x00,0xF8,0x08,0x08,	// 0xDA
-0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,	// 0xDB
-0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,	// 0xDC
-0x00,0x00,0x00,0x77,0x00,0x00,	// 0xDD
-0x00,0x00,0x45,0x7D,0x44,0x00,	// 0xDE
-0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,	// 0xDF
-0x00,0x3C,0x42,0x43,0x3D,0x00,	// 0xE0
-0x00,0xFE,0x4A,0x4A,0x34,0x00,	// 0xE1
-0x00,0x3C,0x43,0x43,0x3D,0x00,	// 0xE2
-0x00,0x3D,0x43,0x42,0x3C,0x00,	// 0xE3
-0x00,0x32,0x49,0x4A,0x31,0x00,	// 0xE4
-0x00,0x3A,0x45,0x46,0x39,0x00,	// 0xE5
-0x00,0xFC,0x20,0x20,0x1C,0x00,	// 0xE6
-0x00,0xFE,0xAA,0x28,0x10,0x00,	// 0xE7
-0x00,0xFF,0xA5,0x24,0x18,0x00,	// 0xE8
-0x00,0x3C,0x40,0x41,0x3D,0x00,	// 0xE9
-0x00,0x3C,0x41,0x41,0x3D,0x00,	// 0xEA
-0x00,0x3D,0x41,0x40,0x3C,0x00,	// 0xEB
-0x00,0x9C,0xA0,0x61,0x3D,0x00,	// 0xEC
-0x00,0x04,0x08,0x71,0x09,0x04,	// 0xED
-0x00,0x00,0x02,0x02,0x02,0x00,	// 0xEE
-0x00,0x00,0x07,0x03,0x00,0x00,	// 0xEF
-0x00,0x00,0x08,0x08,0x08,0x00,	// 0xF0
-0x00,0x00,0x24,0x2E,0x24,0x00,	// 0xF1
-0x00,0x24,0x24,0x24,0x24,0x24,	// 0xF2
-0x05,0x17,0x0A,0x34,0x2A,0x78,	// 0xF3
-0x00,0x06,0x09,0x7F,0x01,0x7F,	// 0xF4
-0x00,0x22,0x4D,0x55,0x59,0x22,	// 0xF5
-0x00,0x08,0x08,0x2A,0x08,0x08,	// 0xF6
-0x00,0x00,0x08,0x18,0x18,0x00,	// 0xF7
-0x00,0x06,0x09,0x09,0x06,0x00,	// 0xF8
-0x00,0x00,0x08,0x00,0x08,0x00,	// 0xF9
-0x00,0x00,0x08,0x00,0x00,0x00,	// 0xFA
-0x00,0x02,0x0F,0x00,0x00,0x00,	// 0xFB
-0x00,0x09,0x0F,0x05,0x00,0x00,	// 0xFC
-0x00,0x09,0x0D,0x0A,0x00,0x00,	// 0xFD
-0x00,0x3C,0x3C,0x3C,0x3C,0x00,	// 0xFE
-0x00,0x00,0x00,0x00,0x00,0x00 	// 0xFF
-};
-
-  ////////////////////////
- //    Misc functions  //
-////////////////////////
-int calc_tuningfactor(void)
-{
-	return (tuningcount * tuningcount) << 1; //2
-}	
-
-  ////////////////////////
- //    SPI for DDS 1   //
-////////////////////////
-void spi1_send_bit(int sbit)
-{
-    DDS1_PORT &= ~(DDS1_SCLK);  //SCLK lo
-    	
-    if(sbit)
-	{
-		DDS1_PORT|= DDS1_SDIO;  //SDATA  set
-	}
-	else
-	{
-		DDS1_PORT &= ~(DDS1_SDIO);  //SDATA  erase
-	}
-	
-    DDS1_PORT |= DDS1_SCLK; //SCLK hi
-	
-}
-
-void spi1_send_byte(unsigned int sbyte)
-{
-    int t1, x = (1 << 7);
-	
-	for(t1 = 0; t1 < 8; t1++)
-	{
-	    spi1_send_bit(sbyte & x);	
-		x >>= 1;
-	}	
-}
-
-void spi1_send_word(unsigned int sword)
-{
-    int t1, x = (1 << 15);
-	
-	for(t1 = 0; t1 < 16; t1++)
-	{
-	    spi1_send_bit(sword & x);	
-		x >>= 1;
-	}	
-}
-
-//SET frequency AD9951 DDS
-//f.clock = 400MHz
-void set_frequency1(long frequency)
-{
-    unsigned long f;
-    unsigned long fword;
-    int t1, t2, shiftbyte = 24, resultbyte, x;
-    unsigned long comparebyte = 0xFF000000;
-	
-	f = frequency;
-		 
-	if(!sideband)//Calculate correct offset from center frequency in display for each sideband
-	{
-	     fword = (unsigned long) (f + INTERFREQUENCY + 1300) * 10.73741824; //USB//21.47483648 200MHz
-	}    
-	else
-    {
-	     fword = (unsigned long) (f + INTERFREQUENCY - 1300) * 10.73741824; //USB
-	}    
-	
-    //Start transfer to DDS
-    DDS1_PORT &= ~(DDS1_IO_UD); //DDS1_IO_UD lo
-    
-	//Send instruction bit to set fequency by frequency tuning word
-	x = (1 << 7);
-	for(t1 = 0; t1 < 8; t1++)
-	{
-	    spi1_send_bit(0x04 & x);	
-		x >>= 1;
-	}	
-	
-    //Calculate and transfer the 4 bytes of the tuning word to DDS
-    //Start with msb
-    for(t1 = 0; t1 < 4; t1++)
-    {
-        resultbyte = (fword & comparebyte) >> shiftbyte;
-        comparebyte >>= 8;
-        shiftbyte -= 8;       
-        x = (1 << 7);
-        for(t2 = 0; t2 < 8; t2++)
-	    {
-	        spi1_send_bit(resultbyte & x);	
-		    x >>= 1;
-	    }	
-    }    
-	
-	//End transfer sequence
-    DDS1_PORT|= (DDS1_IO_UD); //DDS1_IO_UD hi 
-}
-
-  /////////////////
- //  SPI DDS2   //
-/////////////////
-void spi2_start(void)
-{
-	DDS2_PORT |= DDS_SCLK;      //SCLK hi
-    DDS2_PORT &= ~(DDS_FSYNC);  //FSYNC lo
-}
-
-void spi2_stop(void)
-{
-	DDS2_PORT |= DDS_FSYNC; //FSYNC hi
-}
-
-void spi2_send_bit(int sbit)
-{
-    if(sbit)
-	{
-		DDS2_PORT |= DDS_SDATA;  //SDATA hi
-	}
-	else
-	{
-		DDS2_PORT &= ~(DDS_SDATA);  //SDATA lo
-	}
-	
-	DDS2_PORT |= DDS_SCLK;     //SCLK hi
-    
-    DDS2_PORT &= ~(DDS_SCLK);  //SCLK lo
-}
-
-void set_frequency2(unsigned long f)
-{
-
-    double fword0;
-    long fword1, x;
-    int l[] = {0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-    int m[] = {0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, t1;
-    
-    fword0 = (double) 3.579139413 * f; // 3.579139413 = 268435456 / 75000000
-    fword1 = (long) fword0;
-
-    //Transfer frequency word to byte array
-    x = (1 << 13);      //2^13
-    for(t1 = 2; t1 < 16; t1++)
-    {
-		if(fword1 & x)
-	    {
-			l[t1] = 1;
-	    }
-	    x >>= 1;
-    }
-    
-    x = (1L << 27);  //2^27
-    for(t1 = 2; t1 < 16; t1++)
-    {
-	    if(fword1 & x)
-	    {
-	        m[t1] = 1;
-	    }
-	    x >>= 1;
-    }
-    ////////////////////////////////////////
-    
-    //Transfer to DDS
-    //Send start command
-    spi2_start();
-    for(t1 = 15; t1 >= 0; t1--)
-    {
-       spi2_send_bit(0x2000 & (1 << t1));
-    }
-    spi2_stop();
-        
-    //Transfer frequency word	
-    //L-WORD
-    spi2_start();
-    for(t1 = 0; t1 < 16; t1++)
-    {
-       spi2_send_bit(l[t1]);
-    }
-    spi2_stop();
-	
-	//M-WORD
-	spi2_start();
-    for(t1 = 0; t1 < 16; t1++)
-    {
-       spi2_send_bit(m[t1]);
-    }
-    spi2_stop();
-}
-
-void set_lo_freq(int sb)
-{
-			
-	int key;
-	long f = f_lo[sb];
-	
-	lcd_cls(0, 83, 0, 47);
-		
-	lcd_putstring(18, 0, " LO FREQ ", 0, 1);
-	if(!sb)
-	{
-		lcd_putstring(18, 2, "USB", 0, 0);
-	}
-	else	
-	{
-		lcd_putstring(18, 2, "LSB", 0, 0);
-	}
-		
-	key = get_keys();
-	show_frequency2(f);
-	
-	while(key == 0)
-	{
-		if(tuningknob <= -1) //Turn CW
-		{
-			f += 10;
-		    tuningknob = 0;
-	        show_frequency2(f);
-	        set_frequency2(f);
-		}
-
-		if(tuningknob >= 1)  //Turn CCW
-		{    
-		    f -= 10;
-		    tuningknob = 0;
-		    show_frequency2(f);
-		    set_frequency2(f);
-		}		
-		key = get_keys();
-	}
-	
-	if(key == 2)
-	{
-		f_lo[sb] = f; //Confirm
-		store_frequency(f, 35 + sb);
-	}	
-	else
-	{
-		set_frequency2(f_lo[sb]); //Abort and restore old data
-	}	
-}	
-
-  //////////////////////
- //    SPI for LCD   //
-//////////////////////
-//Send the information to LCD (command or data)
-void lcd_sendbyte(char x, int command)
-{ 
-    int t1, bx = 128;
-	
-	if(command)
-	{   //CMD
-	    LCD_PORT &= ~(DC);
-	}
-	else 
-    {  //DATA
-	    LCD_PORT |= DC;
-	} 
-	
-    for(t1 = 0; t1 < 8; t1++)
-    { 
-	    LCD_PORT &= ~(LCDSCLK);
-			    
-        if(x & bx)
-	    {
-            LCD_PORT |= DN; 
-		}
-	    else
-        {
-	        LCD_PORT &= ~(DN);
-	    }	
-        
-		LCD_PORT |= LCDSCLK;
-    	
-		bx >>= 1;
-    }
-}
-
-//Send display data to Nokia LCD 5110
-void lcd_senddata(char x)
-{
-    lcd_sendbyte(x, 0);
-}
-
-//Send  command to Nokia LCD 5110
-void lcd_sendcmd(char x)
-{
-    lcd_sendbyte(x, 1);
-}
-
-//Reset LCD when program starts
-void lcd_reset(void)
-{
-    LCD_PORT &= ~(RES);
-	_delay_us(100);
-    LCD_PORT |= RES;
-}	
-
-//Init NOKIA 5110 LCD
-void lcd_init(void)
-{
-
-    _delay_ms(20);
-	lcd_reset();
-		
-	//Configure the display
-    lcd_sendcmd(0x21);    //Extended commands follow
-    lcd_sendcmd(0xBF);    //Set Vop (Contrast)
-    lcd_sendcmd(0x04);    //Set Temp. coefficient
-    lcd_sendcmd(0x14);    //LCD bias mode
-    lcd_sendcmd(0x20);    //Normal instruction set
-    lcd_sendcmd(0x0C);    //Set display to normal mode.
-	
-	lcd_cleanram();
-    _delay_ms(100);
-}	
-
-//Clear part of LCD
-void lcd_clearsection(int x0, int x1, int y0)
-{
-    int t1;
-	
-	for(t1 = x0; t1 < x1; t1++)
-	{
-	    lcd_gotoxy(t1, y0);
-		lcd_senddata(0x00);
-	}	
-
-}
-
-//Clear whole LCD
-void lcd_cls(int x0, int x1, int y0, int y1)
-{
-    int x, y;
-	
-	for(y = y0; y < y1; y++)
-	{
-	    for(x = x0; x < x1; x++)
-		{
-            lcd_gotoxy(x, y);
-		    lcd_senddata(0x00);
-		}
-	}	
-}
-
-//Set pos of cursor to start next text display on LCD
-void lcd_gotoxy(char x, char y)
-{ 
-    lcd_sendcmd(0x40 | (y & 0x07));
-    lcd_sendcmd(0x80 | (x & 0x7F));
-}
-
-//Init RAM of LCD
-void lcd_cleanram(void)
-{
-    int i;
-    
-	lcd_gotoxy(0,0);
-	
-    _delay_ms(10);
-    
-	for(i = 0; i < 768; i++)
-    {
-        lcd_senddata(0x00);
-	}	
-    
-	_delay_ms(1);
-}
-
-//Power of 2
-int xp2(int xp)
-{
-    int t1, r = 1;
-    for(t1 = 0; t1 < xp; t1++)
-    {
-	    r <<= 1;
-    }
-    return r;
-
-}
-
-//Print character in normal size
-void lcd_putchar1(int col, int row, char ch1, int inv)
-{ 
-    int p, t1;
-    char ch2;
-	
-	lcd_gotoxy(col, row);
-    
-    p = (FONTWIDTH * ch1); // - 32 * FONTWIDTH;
-    for(t1 = FONTWIDTH; t1 > 0; t1--)
-    { 
-	    if(!inv)
-		{
-	        ch2 = xchar[p];
-		}
-		else
-		{
-	        ch2 = ~xchar[p];
-		}
-		
-        lcd_senddata(ch2);
-        p++;
-    }
-	
-	if(!inv)
-	{
-	    lcd_senddata(0x00);
-	}
-	else
-	{
-	    lcd_senddata(0xFF);
-	}
-}
-
-//Print character in double size
-void lcd_putchar2(int col, int row, char ch1, int inv)
-{ 
-    int p, t1, t2, x;
-	int b, b1, b2; 
-    char colval;
-	   
-    p = (FONTWIDTH * ch1);// - FONTWIDTH * 32;
-    	
-	for(t2 = 0; t2 < FONTWIDTH; t2++)
-    { 
-	    //Get vertical byte data of char
-		if(!inv)
-		{
-	        colval = xchar[p];
-		}
-		else
-		{
-	        colval = ~xchar[p];
-		}
-	  		
-		b = 0;
-		x = 1;
-        
-		for(t1 = 0; t1 < 7; t1++)
-        {
-            if(colval & x)
-            {
-	            b += xp2(t1 * 2);
-	            b += xp2(t1 * 2 + 1);
-            }
-            x <<= 1;
-	    }
-    
-        b1 = b & 0xFF; //Lower byte
-        b2 = (b & 0xFF00) >> 8; //Upper byte
-		
-		//Print data to screen
-		lcd_gotoxy(col + t2 * 2, row);
-		lcd_senddata(b1);
-		lcd_gotoxy(col + t2 * 2, row + 1);
-		lcd_senddata(b2);
-		lcd_gotoxy(col + t2 * 2 + 1, row);
-		lcd_senddata(b1);
-		lcd_gotoxy(col + t2 * 2 + 1, row + 1);
-		lcd_senddata(b2);
-		p++;
-	}	
-    
-    lcd_senddata(0x00);
-}
-
-//Print string in certain size
-void lcd_putstring(int col, int row, char *s, char lsize, int inv)
-{
-    int c = col;
-	
-	while(*s)
-	{
-	    if(!lsize)
-		{
-	        lcd_putchar1(c, row, *s++, inv);
-		}
-        else
-        {
-            lcd_putchar2(c, row, *s++, inv);
-		}	
-		c += (lsize + 1) * FONTWIDTH;
-	}
-}
-
-//Print a number
-void lcd_putnumber(int col, int row, long num, int dec, int lsize, int inv)
-{
-    char *s = malloc(16);
-	if(s != NULL)
-	{
-	    int2asc(num, dec, s, 16);
-	    lcd_putstring(col, row, s, lsize, inv);
-	    free(s);
-	}	
-}
-
-void lcd_drawbox(int x0, int y0, int x1, int y1)
-{
-	int t1;
-	
-	for(t1 = x0 + FONTWIDTH; t1 < x1; t1 += FONTWIDTH)
-	{
-		lcd_putchar1(t1, y0, 0xC4, 0);
-		lcd_putchar1(t1, y1, 0xC4, 0);
-	}
-	
-	for(t1 = y0 + 1; t1 < y1; t1++)
-	{
-		lcd_putchar1(x0, t1, 0xB3, 0);
-		lcd_putchar1(x1, t1, 0xB3, 0);
-	}
-	
-	lcd_putchar1(x0, y0, 0xDA, 0); //Left top corner
-	lcd_putchar1(x1, y0, 0xBF, 0); //Right top corner
-	lcd_putchar1(x0, y1, 0xC0, 0); //Left bottom corner
-	lcd_putchar1(x1, y1, 0xD9, 0); //Right bottom corner
-}
-		
-
-  //////////////////////
- // STRING FUNCTIONS //
-//////////////////////
-//INT 2 ASC
-int int2asc(long num, int dec, char *buf, int buflen)
-{
-    int i, c, xp = 0, neg = 0;
-    long n, dd = 1E09;
-
-    if(!num)
-	{
-	    *buf++ = '0';
-		*buf = 0;
-		return 1;
-	}	
-		
-    if(num < 0)
-    {
-     	neg = 1;
-	    n = num * -1;
-    }
-    else
-    {
-	    n = num;
-    }
-
-    //Fill buffer with \0
-    for(i = 0; i < 12; i++)
-    {
-	    *(buf + i) = 0;
-    }
-
-    c = 9; //Max. number of displayable digits
-    while(dd)
-    {
-	    i = n / dd;
-	    n = n - i * dd;
-	
-	    *(buf + 9 - c + xp) = i + 48;
-	    dd /= 10;
-	    if(c == dec && dec)
-	    {
-	        *(buf + 9 - c + ++xp) = '.';
-	    }
-	    c--;
-    }
-
-    //Search for 1st char different from '0'
-    i = 0;
-    while(*(buf + i) == 48)
-    {
-	    *(buf + i++) = 32;
-    }
-
-    //Add minus-sign if neccessary
-    if(neg)
-    {
-	    *(buf + --i) = '-';
-    }
-
-    //Eleminate leading spaces
-    c = 0;
-    while(*(buf + i))
-    {
-	    *(buf + c++) = *(buf + i++);
-    }
-    *(buf + c) = 0;
-	
-	return c;
-}
-
-//STRLEN
-int strlen(char *s)
-{
-   int t1 = 0;
-
-   while(*(s + t1++));
-
-   return (t1 - 1);
-}
-
- ////////////////////////////////////////////
- //     RADIO DATA DISPLAY ROUTINES        // 
-////////////////////////////////////////////
-//Current frequency (double letter height)
-void show_frequency(unsigned long f)
-{
-	if(f == 0)
-	{
-	    lcd_putstring(0, 2, "       ", 1, 0);
-	}
-	else
-	{
-		lcd_putnumber(0, 2, f / 100, 1, 1, 0);
-	}	    
-	    
-}
-
-//Memeory frequency on selection memplace in menu
-void show_frequency2(unsigned long f)
-{
-	if(!f)
-	{
-		lcd_putstring(12, 4, "-------", 0, 0);
-	}
-	else
-	{	
-        lcd_putstring(12, 4, "       ", 0, 0);
-	    lcd_putnumber(12, 4, f / 100, 1, 0, 0);
-	}    
-}	
-
-void show_sideband(int sb, int invert)
-{
-	int xpos = 0, ypos = 0, xlen = 3;
-    char *sb_str[] = {"USB", "LSB"};
-		
-	//Clear section of LCD
-	lcd_clearsection(xpos * FONTWIDTH, xpos + xlen * 6, ypos);
-	
-	//Write string to position
-	lcd_putstring(xpos * FONTWIDTH, ypos, sb_str[sb], 0, invert);
-}
-
-void show_voltage(int v1)
-{
-    char *buf;
-	int t1, p;
-	int xpos = 9, ypos = 0, xlen = 5;
-	
-	lcd_clearsection(xpos * FONTWIDTH, (xpos + xlen) * FONTWIDTH, ypos);
-	
-	buf = malloc(10);
-	//Init buffer string
-	for(t1 = 0; t1 < 10; t1++)
-	{
-	    *(buf + t1) = 0;
-	}
-    p = int2asc(v1, 1, buf, 6) * FONTWIDTH;
-    lcd_putstring(xpos * FONTWIDTH, ypos, buf, 0, 0);
-	lcd_putchar1(xpos * FONTWIDTH + p, ypos, 'V', 0);
-	free(buf);
-}
-
-//S-Meter bargraph (Page 6)
-void show_meter(int sv0)
-{
-    int t1;
-    
-    int sv = sv0 + (sv0 >> 1);
-	
-    if(sv > 83)
-	{
-	    sv = 83;
-	}
-	
-	//Clear bar graph
-	for(t1 = 0; t1 < smax - 2; t1 += 2)
-	{
-	    lcd_gotoxy(t1, 4);
-		lcd_senddata(0x00);
-	}	
-    
-	//Draw new bar graph
-	for(t1 = 0; t1 < sv; t1 += 2)
-	{
-	    lcd_gotoxy(t1, 4);
-		lcd_senddata(0x7E);
-	}	
-	
-	if(sv > smax)
-	{
-		smax = sv;
-		runseconds10s = runseconds10;
-	}	
-	
-}
-
-//Reset max value of s meter
-void reset_smax(void)
-{
-	int t1;
-	
-	//Clear bar graph
-	for(t1 = 0; t1 < smax; t1 += 2)
-	{
-	    lcd_gotoxy(t1, 4);
-		lcd_senddata(0x00);
-	}	
-	
-	runseconds10s = runseconds10;
-	smax = 0;	
-}	
-
-void show_mem_addr(int mem_addr, int invert)
-{
-	int xpos = 0, ypos = 1, xlen = 3;
-    unsigned long mem_freq;
-    		
-	//Clear section of LCD
-	lcd_clearsection(xpos * FONTWIDTH, xpos + xlen * 6, ypos);
-	
-	//Show number of mem place
-	lcd_putstring(xpos * FONTWIDTH, ypos, "M", 0, invert);
-	if(mem_addr < 10)
-	{
-	     lcd_putnumber((xpos + 1) * FONTWIDTH, ypos, 0, -1, 0, invert);				
-	     lcd_putnumber((xpos + 2) * FONTWIDTH, ypos, mem_addr, -1, 0, invert);				
-	}
-	else
-	{
-	     lcd_putnumber((xpos + 1) * FONTWIDTH, ypos, mem_addr, -1, 0, invert);				
-	}
-	
-	//Show respective frequency
-	mem_freq = load_frequency(mem_addr);
-	if(is_mem_freq_ok(mem_freq))
-	{
-	    show_mem_freq(mem_freq, invert);
-	}
-	else    
-	{
-	    show_mem_freq(0, invert);
-	}   
-}
-
-void show_mem_freq(unsigned long f, int invert)
-{
-	
-	int xpos = 4, ypos = 1, xlen = 8;
-    		
-	//Clear section of LCD
-	lcd_clearsection(xpos * FONTWIDTH, xpos + xlen * 6, ypos);
-	
-	if(f)
-	{
-	    lcd_putnumber(xpos * FONTWIDTH, ypos, f / 100, 1, 0, invert);			
-	}   
-	else
-	{
-	    lcd_putstring(xpos * FONTWIDTH, ypos, " ----- ", 0, invert);			
-	}    
-}	
-
-void show_pa_temp(int patemp)
-{
-    char *buf;
-    int t1, p;
-	int xpos = 4, ypos = 0, xlen = 5;
-	
-	lcd_clearsection(xpos * FONTWIDTH, (xpos + xlen) * 6, ypos);
-		
-	buf = malloc(10);
-	//Init buffer string
-	for(t1 = 0; t1 < 10; t1++)
-	{
-	    *(buf + t1) = 0;
-	}
-    p = int2asc(patemp / 10, -1, buf, 6);
-    lcd_putstring(xpos * FONTWIDTH, ypos, buf, 0, 0);
-    lcd_putchar1((xpos + p) * FONTWIDTH, ypos, 0xF8, 0); //Symbol #248
-	lcd_putstring((xpos + p + 1) * FONTWIDTH, ypos, "C", 0, 0);
-	free(buf);
-}
-
-void show_all_data(unsigned long f,  int sb, int v, int mem, int vfo, int spl)
-{
-	unsigned long f2;
-	
-	lcd_cls(0, 84, 0, 48);
-	
-    show_frequency(f);
-    show_sideband(sb, 0);
-    show_meter_scale(PIND & (1 << PD0));
-    show_voltage(v);
-    show_pa_temp(get_temp());    				
-    show_mem_addr(mem, 0);
-	f2 = load_frequency(mem);
-	if(is_mem_freq_ok(f2))
-	{
-		show_mem_freq(f2, 0);
-	}
-	else
-	{
-		show_mem_freq(0, 0);
-	}
-	show_vfo(vfo, spl);
-		
-}
-
-void show_vfo(int n_vfo, int split)
-{
-	int xpos = 12, ypos = 1;
-	
-	//Write string to position
-	if(!split)
-	{
-	    lcd_putchar1(xpos * FONTWIDTH, ypos, n_vfo + 65, 0);
-	    lcd_putchar1((xpos + 1) * FONTWIDTH, ypos, 32, 0);
-	}   
-	else
-	{
-		if(!n_vfo)
-		{
-	        lcd_putchar1(xpos * FONTWIDTH, ypos, 65, 1);
-	        lcd_putchar1((xpos + 1) * FONTWIDTH, ypos,  66, 0);
-	    }   
-	    else
-	    {
-	        lcd_putchar1(xpos * FONTWIDTH, ypos, 65, 0);
-	        lcd_putchar1((xpos + 1) * FONTWIDTH, ypos, 66, 1);
-	    }   
-	}   
-}	
-
-void show_meter_scale(int scale)
-{
-	int t1;
-	
-	//Define characters for the display line
-    char scalestr[] = {0, 76, 146, 146, 100, 0, 0, 254, 0, 0, 0, 68, 130, 146, 108, 0, 0, 0, 94, 146, 146, 98, 0, 0, 0, 194, 34, 18, 14, 0, 0, 0, 76, 146, 146, 108, 0, 0, 0, 16, 56, 16, 0, 254, 0, 120, 132, 132, 120, 0, 0, 0, 16, 56, 16, 0, 228, 146, 146, 140, 0, 120, 132, 132, 120, 0, 0, 0, 112, 136, 136, 254, 0, 254, 146, 146, 108};
-
-	if(!scale)
-	{
-		lcd_gotoxy(0, 5);
-    
-        for(t1 = 0; t1 < 77; t1++)
-        {
-            lcd_senddata(scalestr[t1]);
-        }   
-	}
-	else
-	{
-		lcd_putstring(0, 5, "2 4 6 8 10W   ", 0, 0);
-	}
-}			
-	
-//////////////////////
-//   E  E  P  R  O  M
-//////////////////////
-void store_frequency(long f, int memplace)
-{
-    long hiword, loword;
-    unsigned char hmsb, lmsb, hlsb, llsb;
-	
-    int start_adr = memplace * 4;
-    
-	cli();
-    hiword = f >> 16;
-    loword = f - (hiword << 16);
-    hmsb = hiword >> 8;
-    hlsb = hiword - (hmsb << 8);
-    lmsb = loword >> 8;
-    llsb = loword - (lmsb << 8);
-
-    while(!eeprom_is_ready());
-    eeprom_write_byte((uint8_t*)start_adr, hmsb);
-
-    while(!eeprom_is_ready());
-    eeprom_write_byte((uint8_t*)start_adr + 1, hlsb);
-
-    while(!eeprom_is_ready());
-    eeprom_write_byte((uint8_t*)start_adr + 2, lmsb);
-
-    while(!eeprom_is_ready());
-    eeprom_write_byte((uint8_t*)start_adr + 3, llsb);
-    
-    sei();	
-}
-
-unsigned long load_frequency(int memplace)
-{
-    long rf;
-    unsigned char hmsb, lmsb, hlsb, llsb;
-    int start_adr = memplace * 4;
-		
-    cli();
-    hmsb = eeprom_read_byte((uint8_t*)start_adr);
-    hlsb = eeprom_read_byte((uint8_t*)start_adr + 1);
-    lmsb = eeprom_read_byte((uint8_t*)start_adr + 2);
-    llsb = eeprom_read_byte((uint8_t*)start_adr + 3);
-	sei();
-	
-    rf = (long) 16777216 * hmsb + (long) 65536 * hlsb + (unsigned int) 256 * lmsb + llsb;
-		
-	return rf;
-	
-}
-
-void store_last_mem(int mem)
-{
-	eeprom_write_byte((uint8_t*)127, mem);
-}
-
-void store_last_vfo(int vfo)
-{
-	eeprom_write_byte((uint8_t*)128, vfo);
-}
-
-int load_last_mem(void)
-{
-	return eeprom_read_byte((uint8_t*)127);
-}
-
-int load_last_vfo(void)
-{
-	return eeprom_read_byte((uint8_t*)128);
-}
-
-void store_vfo_data(int vfo, unsigned long f0, unsigned long f1)
-{
-	store_last_vfo(vfo);
-	store_frequency(f0, 16); //VFO A
-	store_frequency(f1, 17); //VFO B
-}	
-
-long recall_mem_freq(void)
-{
-	int mem_addr = 0;
-	int key;
-	
-	lcd_cls(0, 83, 0, 47);
-	lcd_putstring(12, 0, "RECALL QRG", 0, 0);
-	
-	//Load initial freq
-	if(is_mem_freq_ok(load_frequency(mem_addr)))
-	{
-		show_mem_addr(mem_addr, 0);
-	    set_frequency1(load_frequency(mem_addr));
-		show_frequency(load_frequency(mem_addr));
-	}  
-	else  
-	{
-		show_mem_addr(mem_addr, 0);
-		show_frequency(0);
-	}	
-	
-	key = 0;
-	while(!key)
-	{
-		if(tuningknob >= 1)  
-		{    
-		    if(mem_addr > 0)
-		    {
-			    mem_addr--;
-			}
-			else     
-			{
-			    mem_addr = MAXMEM;
-			}	 
-			
-			tuningknob = 0;
-			
-			show_mem_addr(mem_addr, 0);
-			if(is_mem_freq_ok(load_frequency(mem_addr)))
-			{
-			    set_frequency1(load_frequency(mem_addr));
-			    show_frequency(load_frequency(mem_addr));
-			}    
-	    }
-		
-		if(tuningknob <= -1)
-		{    
-		    if(mem_addr < MAXMEM)
-		    {
-			    mem_addr++;
-			}
-			else     
-			{
-			    mem_addr = 0;
-			}	 
-			
-			tuningknob = 0;
-			
-			show_mem_addr(mem_addr, 0);
-			if(is_mem_freq_ok(load_frequency(mem_addr)))
-			{
-			    set_frequency1(load_frequency(mem_addr));
-			    show_frequency(load_frequency(mem_addr));
-            }    
-	    }
-	    
-	    key = get_keys();
-	}	
-	            
-	switch(key)
-	{
-	    case 2: if(is_mem_freq_ok(load_frequency(mem_addr)))
-	            {
-	                store_last_mem(mem_addr);
-	                return(load_frequency(mem_addr));
-	            }    
-				break;
-	}	
-								
-    while(get_keys());
-    
-    return 0;
-}	
-
-int save_mem_freq(long f, int mem)
-{
-    int mem_addr = mem;
-	int key;
-	
-	lcd_cls(0, 83, 0, 47);
-	lcd_putstring(12, 0, "STORE QRG", 0, 0);
-	
-	//Load initial mem
-	show_mem_addr(mem_addr, 0);
-	set_frequency1(load_frequency(mem_addr));
-	show_frequency(f);
-			
-	key = 0;
-	while(!key)
-	{
-		if(tuningknob >= 1)  
-		{    
-		    if(mem_addr > 0)
-		    {
-			    mem_addr--;
-			}
-			else     
-			{
-			    mem_addr = MAXMEM;
-			}	 
-			
-			tuningknob = 0;
-			
-			show_mem_addr(mem_addr, 0);
-			if(is_mem_freq_ok(load_frequency(mem_addr)))
-			{
-			    set_frequency1(load_frequency(mem_addr));
-			}    
-	    }
-		
-		if(tuningknob <= -1)
-		{    
-		    if(mem_addr < MAXMEM)
-		    {
-			    mem_addr++;
-			}
-			else     
-			{
-			    mem_addr = 0;
-			}	 
-			
-			tuningknob = 0;
-			
-			show_mem_addr(mem_addr, 0);
-			if(is_mem_freq_ok(load_frequency(mem_addr)))
-			{
-			    set_frequency1(load_frequency(mem_addr));
-			}    
-	    }
-	    
-	    key = get_keys();
-	}	
-	            
-	switch(key)
-	{
-	    case 2:     store_last_mem(mem_addr);
-	                store_frequency(f, mem_addr);
-	                return mem_addr;
-	            	break;
-	}	
-								
-    while(get_keys());
-    
-    return -1;
-    
-    
-}	
-
-  //////////////////////
- //    A   D   C     //
-/////////////////////
-//Read ADC value
-int get_adc(int adc_channel)
-{
-	int adc_val = 0;
-	
-	//ADC config and ADC init
-    ADCSRA = (1<<ADEN) | (1<<ADPS2) | (1<<ADPS1); //Activate ADC, Prescaler=64
-
-	ADMUX = (1 << REFS0) + adc_channel;     //Read ADC channel with Vref=VCC
-	
-    _delay_ms(3);
-	
-    ADCSRA |= (1<<ADSC);
-    while(ADCSRA & (1<<ADSC));
-	_delay_ms(3);
-	
-	ADCSRA |= (1<<ADSC);
-    while(ADCSRA & (1<<ADSC));
-	
-	adc_val = ADCL;
-    adc_val += ADCH * 256;   
-	
-	ADCSRA &= ~(1<<ADEN); //Deactivate ADC
-	
-	return adc_val;
-}	
-
-//Read keys via ADC0
-int get_keys(void)
-{
-
-    int key_value[] = {86, 31, 50, 38};
-    int t1;
-    int adcval = get_adc(0);
-        
-    //TEST display of ADC value 
-    //lcd_putstring(0, 3, "----", 0, 0);    
-    //lcd_putnumber(0, 3, adcval, -1, 0, 0);    
-    		
-    for(t1 = 0; t1 < 4; t1++)
-    {
-        if(adcval > key_value[t1] - 3 && adcval < key_value[t1] + 3)
-        {
-             return t1 + 1;
-        }
-    }
-    return 0;
-}
-
-//Measure temperature of final amplifier
-//Sensor = KTY81-210
-int get_temp(void)
-{
-    double temp;
-	double rt, rv = 5100, ut;
-	double r0 = 1630; //Resistance of temperature sensor at 0C
-	double m = 17.62;   //slope of temperature sensor in Ohms/K
-	
-	//Calculate voltage from ADC value
-	ut = (double)get_adc(4) * 5 / 1024;
-	
-	//Calculate thermal resistor value from ADC voltage ut
-	rt = rv / (5 / ut - 1);
-	
-	//Calculate temperature from rt
-	temp = 10 * ((rt - r0) / m);
-		
-	return (int)(temp);
-}	
-
-  /////////////////////////
- // INTERRUPT HANDLERS  //
-/////////////////////////
-//Rotary encoder
-ISR(INT0_vect)
-{ 
-    int gray = (PIND & 0x0C) >> 2;           // Read PD2 and PD3
-	int state = (gray >> 1) ^ gray;         // Convert from Gray code to binary
-
-    if((state == 0) || state == 2) 
-    {
-		tuningknob = 1;
-		tuningcount++;
-	}
-	
-	if((state == 1) || state == 3) 
-    {
-		tuningknob = -1;
-		tuningcount++;
-	}	
-}
-
-//Timer1
-ISR(TIMER1_OVF_vect)
-{
-    runseconds10++;
-    tuningcount = 0;
-    
-    TCNT1 = 63973;
-}
-
-  ////////////////////////////////////////////
- //    Store or recall Frequency handling //
-//////////////////////////////////////////
-int is_mem_freq_ok(unsigned long f)
-{
-	if(f >= 13900000 && f <= 14400000)
-	{
-		return 1;
-	}	
-	else
-	{
-		return 0;
-	}		
-}	
-
-//Scan==0: scan memories, scan=1: scan band
-long scan(int mode)
-{
-    int t1 = 0;
-    long f0, f1, df, runsecsold10scan = 0;
-    int key = 0;
-    int sval;
-    
-    int scan_skip[MAXMEM];
-    
-    for(t1 = 0; t1 < MAXMEM; t1++)
-    {
-		scan_skip[t1] = 0;
-	}
-	
-    while(get_keys());
-    
-    if(!mode)
-    {
-		key = 0;
-        while(key != 1 && key != 2) //Scan memories
-	    {
-		    t1 = 0;
-		    while(t1 < 15 && !key)
-		    {
-			    f0 = load_frequency(t1);
-				if(is_mem_freq_ok(f0) && !scan_skip[t1])
-				{
-					set_frequency1(f0);
-				    show_frequency(f0);
-				    show_mem_addr(t1, 0);
-				    				    
-				    sval = get_adc(2); //ADC voltage on ADC2 SVAL
-				    show_meter(sval); //S-Meter
-				    while(sval > s_threshold && !key)
-				    {
-		 	            runsecsold10scan = runseconds10;
-		 	            key = get_keys();
-		 	            while(runseconds10 < runsecsold10scan + 1 && !key)
-		 	            {
-							key = get_keys();
-					    }	
-		 	            sval = get_adc(2);
-		 	            show_meter(sval); //S-Meter
-		 	        }
-					
-				    runsecsold10scan = runseconds10;
-				    while(runseconds10 < runsecsold10scan + 20 && !key)
-			        {
-						key = get_keys();
-						sval = get_adc(2);
-		 	            show_meter(sval); //S-Meter
-					}	
-			    } 
-			    else  
-			    {
-					key = get_keys();
-				}	
-				
-				while(get_keys());
-				
-				if(key == 4)
-				{
-					scan_skip[t1] = 1;
-					key = 0;
-				}	
-				t1++;
-				reset_smax();
-			}
-		}
-		t1--;
-				
-		while(get_keys());
-				
-		if(key == 2)
-		{
-			return(t1); //Set this memory frequency as new operating QRG
-		}
-		else
-		{
-			return(-1);
-		}	
-	}
-	
-	if(mode == 1)  //Scan band
-	{			
-	    while(!key) 
-	    {
-	        f0 = scanfreq[0];
-			f1 = scanfreq[1];
-		    
-		    df = 0;
-		    
-		    while(f0 + df <= f1 && !key)
-		    {
-		        set_frequency1(f0 + df);
-			    show_frequency(f0 + df);
-			    df += 100;
-			    
-			    sval = get_adc(2); //ADC voltage on ADC2 SVAL
-			    show_meter(sval); //S-Meter
-				
-		 	    while(sval > s_threshold && !get_keys())
-				{
-					runsecsold10scan = runseconds10;
-		 	        key = get_keys();
-		 	        while(runseconds10 < runsecsold10scan + 1 && !key)
-		 	        {
-						key = get_keys();
-					}	
-		 	        sval = get_adc(2);
-		 	        show_meter(sval); //S-Meter
-		 	    }
-			    key = get_keys();
-			}
-		}
-								
-		while(get_keys());
-				
-		if(key == 2)
-		{
-			return(f0 + df); //Set this memory frequency as new operating QRG
-		}
-		else
-		{
-			return(-1);
-		}			
-	}				    
-	return(-1);
-}	
-
-//Scans 16 memories
-void set_scan_threshold(void)
-{
-	int xpos0 = 3;
-	int ypos0 = 0;
-    int key = 0;
-    int thresh = s_threshold;
-    
-    lcd_cls(0, 83, 0, 47);
-    show_meter(thresh);
-    show_meter_scale(0);
-        
-    lcd_putstring(6, ypos0, " SCAN THRESH ", 0, 1);
-        
-    lcd_putstring(xpos0, ypos0 + 2, "  ", 0, 0);
-    lcd_putnumber(xpos0, ypos0 + 2, thresh, -1, 0, 0);
-    
-    	
-    while(!key)
-    {
-        if(tuningknob <= -1) //Turn CW
-		{
-			if(thresh < 80)
-			{
-				thresh++;
-			}
-			show_meter(thresh);
-	
-            lcd_putstring(xpos0, ypos0 + 2, "  ", 0, 0);
-            lcd_putnumber(xpos0, ypos0 + 2, thresh, -1, 0, 0);
-    
-			tuningknob = 0;
-		}
-
-		if(tuningknob >= 1)  //Turn CCW
-		{    
-			if(thresh > 0)
-			{
-				thresh--;
-			}
-			show_meter(thresh);
-			 
-            lcd_putstring(xpos0, ypos0 + 2, "  ", 0, 0);
-            lcd_putnumber(xpos0, ypos0 + 2, thresh, -1, 0, 0);
-    
-			tuningknob = 0;
-		}		
-		key = get_keys();
-	}
-	
-	if(key == 2)
-	{
-		s_threshold = thresh;
-		eeprom_write_byte((uint8_t*)129, s_threshold);
-	}	
-	
-}	
-
-//Scans a frequency range defined by 2 edge frequencies
-long set_scan_frequency(int fpos, long f0)
-{
-	int xpos0 = 3;
-	int ypos0 = 0;
-    int key = 0;
-    long f1 = f0;
-    
-    lcd_cls(0, 83, 0, 47);
-        
-    lcd_putstring(xpos0, ypos0, "SET SCAN FREQ", 0, 1);
-    if(!fpos)
-    {
-        lcd_putstring(xpos0, ypos0 + 1, "FREQUENCY0:", 0, 0);
-    }   
-    else
-    {
-        lcd_putstring(xpos0, ypos0 + 1, "FREQUENCY1:", 0, 0);
-    }   
-        
-    show_frequency(f1);
-        	
-    while(!key)
-    {
-        if(tuningknob <= -1) //Turn CW
-		{
-			if(f1 < 14400000)
-			{
-				f1 += 100;
-			}
-				
-            show_frequency(f1);
-            set_frequency1(f1);
-			tuningknob = 0;
-		}
-
-		if(tuningknob >= 1)  //Turn CCW
-		{    
-			if(f1 > 0)
-			{
-				f1 -= 100;
-			}
-			 
-            show_frequency(f1);
-            set_frequency1(f1);
-			tuningknob = 0;
-		}		
-		key = get_keys();
-	}
-	
-	if(key == 2)
-	{
-		store_frequency(f1, 33 + fpos);
-		scanfreq[fpos] = f1;
-		return f1;
-	}	
-	
-	return 0;
-	
-}
-
-//Displays the data of the currently used main VFO
-int set_vfo(int xvfo, int xsplit)
-{
-    //Store values
- 	store_frequency(f_vfo[0], 16); //VFO A
-	store_frequency(f_vfo[1], 17); //VFO B
-	    
-	show_vfo(xvfo, xsplit);
-	set_frequency1(f_vfo[xvfo]);
-	show_frequency(f_vfo[xvfo]);
-	store_last_vfo(xvfo);
-	
-    return xvfo;			        
-}	
-
-  //////////
- // MENU //
-//////////
-void print_menu_head(char *head_str0, char *head_str1, int m_items)
-{	
-    int xpos0 = 3;
-	int ypos0 = 1;
-		
-	lcd_cls(0, 84, 0, 48);
-	lcd_drawbox(34, 0, 80, m_items + 2);
-	lcd_putstring(xpos0, ypos0, head_str0, 0, 0);
-	lcd_putstring(xpos0, ypos0 + 1, head_str1, 0, 0);
-}
-
-void print_menu_item(char *m_str, int ypos, int inverted)
-{
-	int xpos1= 40;
-	
-	lcd_putstring(xpos1, ypos + 1, m_str, 0, inverted);
-}
-	
-//Print the itemlist or single item
-void print_menu_item_list(int m, int item, int invert)
-{
-	int menu_items[] =    {3, 1, 3, 1, 2}; 
-	
-	char *menu_str[5][4] =    {{"VFO A ", "VFO B ", "A=B   ", "B=A   "},
-		                       {"RECALL", "STORE ", "      ", "      "}, 
-	                           {"MEMORY", "BAND  ", "LIMITS", "THRESH"},
-	                           {"ON    ", "OFF   ", "      ", "      "}, 
-	                           {"USB   ", "LSB   ", "RESET ", "      "}};
-    int t1;
-    
-    if(item == -1)
-    {
-        //Print item list for menu
-	    for(t1 = 0; t1 < menu_items[m] + 1; t1++)
-	    {
-		    print_menu_item(menu_str[m][t1], t1, 0);   
-	    }	
-	}
-	else	
-	{
-		print_menu_item(menu_str[m][item], item, invert);   
-	}	
-}
-
-//Returns menu_pos if OK or -1 if aborted
-int navigate_thru_item_list(int m, int maxitems)
-{
-	int menu_pos = 0;
-	
-	print_menu_item_list(m, menu_pos, 1)   ;     //Write 1st entry in normal color
-	
-	int key = get_keys();
-	
-    while(key == 0)
-	{
-		if(tuningknob <= -1) //Turn CW
-		{
-			print_menu_item_list(m, menu_pos, 0); //Write old entry in normal color
-		    if(menu_pos < maxitems)
-		    {
-				menu_pos++;
-			}
-			else	
-			{
-				menu_pos = 0;
-			}
-			print_menu_item_list(m, menu_pos, 1); //Write new entry in reverse color
-		    tuningknob = 0;
-		}
-
-		if(tuningknob >= 1)  //Turn CCW
-		{    
-		    print_menu_item_list(m, menu_pos, 0); //Write old entry in normal color
-		    if(menu_pos > 0)
-		    {
-				menu_pos--;
-			}
-			else	
-			{
-				menu_pos = maxitems;
-			}
-			print_menu_item_list(m, menu_pos, 1); //Write new entry in reverse color
-		    tuningknob = 0;
-		}		
-				
-		key = get_keys();
-	}
-		
-	while(get_keys());
-	
-	switch(key)
-	{   case 1: return -1;       //Next menu!
-		        break;
-	    case 2: return menu_pos; //OK
-	            break;
-	    case 3: return -3;       //Quit menu!
-	            break;
-	}
-	
-	return -1;
-}	
-			
-long menux(long f, int c_vfo)
-{
-	
-	int result = 0;
-	int menu;
-	int menu_items[] = {3, 1, 3, 1, 2};
-	
-	////////////////
-	// VFO FUNCS  //
-	////////////////
-	while(get_keys());
-		
-	menu = 0;
-	print_menu_head("VFO", "", menu_items[menu]);	//Head outline of menu
-	print_menu_item_list(menu, -1, 0);              //Print item list in full
-	
-	//Navigate thru item list
-	result = navigate_thru_item_list(menu, menu_items[menu]);
-	if(result > -1)
-	{
-		return(menu * 10 + result);
-	}
-	else
-	{
-		switch(result)
-		{				
-		    case -3: return -3; //Quit menu         
-		             break;
-		    case -1: break;
-		}
-    }		
-    
-	////////////////
-	//MEMORY FUNCS//
-	////////////////
-	menu = 1;
-	print_menu_head("MEMO", "", menu_items[menu]);	//Head outline of menu
-	print_menu_item_list(menu, -1, 0);              //Print item list in full
-		
-	//Navigate thru item list
-	result = navigate_thru_item_list(menu, menu_items[menu]);
-	if(result > -1)
-	{
-		return(menu * 10 + result);
-	}
-	else
-	{
-		switch(result)
-		{	
-		    case -3: return -3; //Quit menu         
-		             break;
-		    case -1: break;
-		}
-    }
-		
-	////////////////
-	// SCAN FUNCS //
-	////////////////
-	while(get_keys());
-		
-	menu = 2;
-    print_menu_head("SCAN", "", menu_items[menu]);	//Head outline of menu
-	print_menu_item_list(menu, -1, 0);              //Print item list in full
-	   
-	//Navigate thru item list
-	result = navigate_thru_item_list(menu, menu_items[menu]);
-					
-	if(result > -1)
-	{
-		return(menu * 10 + result);
-	}
-	else
-	{
-		switch(result)
-		{	
-		    case -3: return -3; //Quit menu         
-		             break;
-		    case -1: break;
-		}
-    }
-    
-	////////////////
-	// SPLIT MODE //
-	////////////////
-	while(get_keys());
-	
-	menu = 3;
-	print_menu_head("SPLIT", "MODE", menu_items[menu]);	//Head outline of menu
-	print_menu_item_list(menu, -1, 0);              //Print item list in full
-	
-    //Navigate thru item list
-	result = navigate_thru_item_list(menu, menu_items[menu]);
-					
-	if(result > -1)
-	{
-		return(menu * 10 + result);
-	}
-	else
-	{
-		switch(result)
-		{	
-		    case -3: return -3; //Quit menu         
-		             break;
-		    case -1: break;
-		}
-    }
-    
-	/////////////////
-	// LO SET MODE //
-	/////////////////
-	while(get_keys());
-	
-	menu = 4;
-	print_menu_head("LO", "FREQ", menu_items[menu]);	//Head outline of menu
-	print_menu_item_list(menu, -1, 0);              //Print item list in full
-	   
-	//Navigate thru item list
-	result = navigate_thru_item_list(menu, menu_items[menu]);
-					
-	if(result > -1)
-	{
-		return(menu * 10 + result);
-	}
-	else
-	{
-		switch(result)
-		{	
-		    case -3: return -3; //Quit menu         
-		             break;
-		    case -1: break;
-		}
-    }
-    
-	return -2; //Nothing to do in main()
-}
-
-  //////////
- // MAIN //
-//////////
-int main(void)
-{
-	//Universal counter(s)
-	int t1; 
-	
-	unsigned long runseconds10sc = 0;
-	
-	//ADC
-	int adcval;
-	
-	//Frequencies and VFO
-    unsigned long freq_temp;
-    int cur_vfo = 0;
-    int split = 0;
-    
-    //Menu
-	long menu_ret = 0;
-		
-    //Counting
-    //unsigned long runseconds10a = 0;
-    long runseconds10b = 0;
-            
-    //Key detection
-    int key = 0;
-    long runseconds10key = 0;
-
-    //Voltage measurement
-    double volts0 = 0;
-    long runseconds10e = 0;
-    int volts1 = 0, volts1_old = 0;
-
-    //Meter
-    unsigned long runseconds10c = 0;
-        
-    //PA temp measurement
-    int pa_temp, pa_temp_old = 0;
-    unsigned long runseconds10patemp = 0;
-    
-    //TX/RX detection
-    int txrx = 0, txrx_old = 0;
-        
-    //Sideband detection
-    int sideband_old = sideband;
-        
-    //DDS 1          
-    //Set DDRB of DDSPort1 and DDS Resetport  
-	DDRB = 0x0F; //SPI-Lines + RESET line on PB0..PB3
-	
-	//DDS 2
-    DDRC = 0x0F;
-    
-	//Set DDR of LCDPort
-	DDRD = 0xF0; //PD0..PD3: Display lines: CLK DIN DC RST
-    
-    //Input (analog & digital)
-    PORTA = 0x01; //Pull-up resistor for key recognition on PA0
-
-    //PORTD pullup
-    PORTD = (1 << PD1); //Sideband switch detection
-    
-	//Interrupt definitions for rotary encoder attached to PD2 and PD3
-	EIMSK = (1 << INT0);; //Activate INT0 only
-	EICRA = (1 << ISC00);   // Trigger INT0 on pin change
-	PCICR = (1 << PCIE0); //Pin Change Interrupt Enable 0
-	
-    //Timer 1 as 10th-second counter
-    TCCR1A = 0;             // normal mode, no PWM
-    TCCR1B = (1<<CS12) | (1<<CS10); // Prescaler = /1024 based on system clock 16MHz => 15625 inc per s
-	TIMSK1 = (1 << TOIE1);  // overflow active
-	TCNT1 = 63973;          // start value for 10 overflows per s
-	
-	//INIT LCD
-	lcd_init();
-
-	//Reset DDS1 (AD9951)
-	DDS1_PORT &= ~(1 << DDS1_RESETPIN);          
-    _delay_ms(1);
-	DDS1_PORT |= (1 << DDS1_RESETPIN);     
-       
-    //Reset DDS2 (AD9834)	
-	_delay_ms(10);	
-	DDS2_PORT |= (1 << DDS2_RESETPIN);   //Bit set
-    _delay_ms(10);       
-	DDS2_PORT &= ~(1 << DDS2_RESETPIN);  //Bit erase        
-	_delay_ms(10);	
-
-    //Load scan threshold
-    s_threshold = eeprom_read_byte((uint8_t*)129);          	
-    if(s_threshold < 0 || s_threshold > 80)
-    {
-		s_threshold = 30;
-	}
-	
-	//Load scan edge frequencies
-	scanfreq[0] = load_frequency(33);
-	if(!is_mem_freq_ok(scanfreq[0]))
-	{
-		scanfreq[0] = 14100000;
-	}	
-	scanfreq[1] = load_frequency(34);
-	if(!is_mem_freq_ok(scanfreq[1]))
-	{
-		scanfreq[1] = 14300000;
-	}
-		
-    //Load last stored freqeuncy
-    //Check if memory place is not a random number anywhere in EEPROM
-    last_memplace = load_last_mem();
-    if(last_memplace < 0 || last_memplace > 15)
-    {
-		last_memplace = 0;
-	}
-	
-	if(is_mem_freq_ok(load_frequency(last_memplace)))
-	{
-		show_mem_freq(load_frequency(last_memplace), 0);
-	}
-	else
-	{	
-		show_mem_freq(0, 0);	
-	}	
-	
-	//Load LO frequencies set by user
-	for(t1 = 0; t1 < 2; t1++)
-	{
-		f_lo[t1] = load_frequency(35 + t1);
-		if(f_lo[t1] < 8995000 || f_lo[t1] > 9005000)
-		{
-			switch(t1)
-			{
-				case 0: f_lo[t1] = 9001500; //USB
-				         break;
-				case 1: f_lo[t1] = 8998500; //LSB
-				         break;        
-			}
-		}
-	}			          
-				
-	//Load VFO data
-	//Set VFO 
-    cur_vfo = load_last_vfo();
-    if(cur_vfo < 0 || cur_vfo > 1)
-    {
-		cur_vfo = 0;
-	}
-	for(t1 = 0; t1 < 2; t1++)    
-	{
-        f_vfo[t1] = load_frequency(16 + t1);
-
-        //Check if freq is in 20m band
-        if(!is_mem_freq_ok(f_vfo[t1]))
-        {
-		    f_vfo[t1] = 14220000;
-		    store_frequency(f_vfo[t1], 16 + t1);
-		}    
-    }
-    //Set this frequency
-    set_frequency1(f_vfo[cur_vfo]);
-        
-    //Set LO
-    set_frequency2(f_lo[sideband]); 
-    set_frequency2(f_lo[sideband]); 
-    set_frequency2(f_lo[sideband]); 
-    
-    //Initial voltage measurement
-    volts0 = (double) get_adc(1) * 5 / 1024 * VOLTAGEFACTOR * 10; 
-	volts1 = (int) volts0;
-	
-	//Fill lcd with all available information 
-    show_all_data(f_vfo[cur_vfo], sideband, volts1, last_memplace, cur_vfo, split);
-        
-	sei();
-	
-	runseconds10b = runseconds10;           	
-    
-    for(;;) 
-	{
-		if(tuningknob <= -1)
-		{
-		    f_vfo[cur_vfo] += calc_tuningfactor();    
-		    tuningknob = 0;
-			set_frequency1(f_vfo[cur_vfo]);    		 
-	        show_frequency(f_vfo[cur_vfo]);    		
-		}
-
-		if(tuningknob >= 1)  
-		{    
-		    f_vfo[cur_vfo] -= calc_tuningfactor();    
-		    tuningknob = 0;
-			set_frequency1(f_vfo[cur_vfo]);    		 
-			show_frequency(f_vfo[cur_vfo]);    	
-		}		
-        
-		//Check if key pressed
-        if(runseconds10 > runseconds10key + 1)
-        {
-		    key = get_keys();
-		    runseconds10key = 0;
-		}   	
-		
-		switch(key)
-		{
-			case 1: menu_ret = menux(f_vfo[cur_vfo], cur_vfo);    //Return values: 0..15: Recall MEM
-			                                            //               16..31: Store current freq in MEM
-			        lcd_cls(0, 83, 0, 47);	            //               32    : Scan MEMs via function scan(int)
-	                while(get_keys());                  // 33: Scan SSB portion , 34: scan CW portion, 
-	                                                    // 64 : Split TX: A, RX B:, 65 vice versa, 66: Split off
-	                volts0 = (double) get_adc(1) * 5 / 1024 * VOLTAGEFACTOR * 10; //Refresh voltage measurement
-	                volts1 = (int) volts0;
-	                
-	                //Fill lcd with all information available
-                    show_all_data(f_vfo[cur_vfo], sideband, volts1, last_memplace, cur_vfo, split);
-    		        	
-	                key = 0;
-			        
-			        //React to user's request in menu
-			        switch(menu_ret)
-			        {
-						case 0:     cur_vfo = 0;  //Set to VFO A
-						            show_vfo(0, 0);
-						            set_frequency1(f_vfo[cur_vfo]);
-						            show_frequency(f_vfo[cur_vfo]);
-						            break;
-						        
-						case 1:     cur_vfo = 1;   //Set to VFO B
-						            show_vfo(1, 0);
-						            set_frequency1(f_vfo[cur_vfo]);
-						            show_frequency(f_vfo[cur_vfo]);
-						            break;
-						        
-						case 2:     f_vfo[0] = f_vfo[1]; //VFO A = VFO B
-						            break; 
-						        
-						case 3:     f_vfo[1] = f_vfo[0]; //VFO B = VFO A
-					                break;
-					    
-					    case 10:    freq_temp = recall_mem_freq();     //Recall QRG  
-					                if(is_mem_freq_ok(freq_temp))
-					                {
-										f_vfo[cur_vfo] = freq_temp;
-										set_frequency1(f_vfo[cur_vfo]);
-										show_frequency(f_vfo[cur_vfo]);
-										last_memplace = load_last_mem();
-										show_mem_addr(last_mem, 0);
-									}	
-									else
-									{
-										set_frequency1(f_vfo[cur_vfo]);
-										show_frequency(f_vfo[cur_vfo]);
-									}	
-					                break;
-					    
-					    case 11:    t1 = save_mem_freq(f_vfo[cur_vfo], last_memplace);
-					                
-					                if(t1 > -1)
-					                {
-										store_frequency(f_vfo[cur_vfo], 16 + cur_vfo);
-										last_memplace = t1;
-										store_last_mem(t1);
-					    			}    
-					    			show_frequency(f_vfo[cur_vfo]);
-					                set_frequency1(f_vfo[cur_vfo]);
-					                
-					                break;
-					                
-					    case 20:    t1 = scan(0);
-					                freq_temp = load_frequency(t1);
-					                if(is_mem_freq_ok(freq_temp))
-					                {
-										f_vfo[cur_vfo] = freq_temp;
-										set_frequency1(f_vfo[cur_vfo]);
-										show_frequency(f_vfo[cur_vfo]);
-									}	
-					                break;
-					    
-					    case 21:    freq_temp = scan(1);
-					                if(is_mem_freq_ok(freq_temp))
-					                {
-										f_vfo[cur_vfo] = freq_temp;
-										set_frequency1(f_vfo[cur_vfo]);
-										show_frequency(f_vfo[cur_vfo]);
-									}	
-					                break;
-					                  
-					    case 22:    scanfreq[0] = set_scan_frequency(0, f_vfo[cur_vfo]);
-					                scanfreq[1] = set_scan_frequency(1, f_vfo[cur_vfo]); 
-					                break;
-					                
-					    case 23:    set_scan_threshold();            
-					                break;
-					                
-					    case 30:  	split = 1;
-					                if(cur_vfo == 0)
-						            {
-										vfo_x = 0;
-										vfo_y = 1;
-									}	
-									else
-									{
-										vfo_x = 1;
-										vfo_y = 0;
-									}	
-						            show_vfo(cur_vfo, 1);
-						            break;
-						
-						case 31:  	split = 0;
-						            show_vfo(cur_vfo, 0);
-						            break;
-						
-						case 40:    set_lo_freq(0);
-						            break;       
-						              
-						case 41:    set_lo_freq(1);
-						            break;   
-						            
-						case 42:    f_lo[0] = 9001500;
-						            store_frequency(f_lo[0], 35);
-						            f_lo[1] = 8998500;
-						            store_frequency(f_lo[1], 36);
-						            set_frequency2(f_lo[sideband]);
-						            break;                                 
-					}	
-					show_all_data(f_vfo[cur_vfo], sideband, volts1, last_memplace, cur_vfo, split);
-					break;
-					
-			case 2: store_last_vfo(cur_vfo);
-			        store_frequency(f_vfo[0], 16); //VFO A
-			        store_frequency(f_vfo[1], 17); //VFO B
-			        store_last_mem(last_memplace);
-			        break;
-			        
- 			case 4: while(get_keys());
- 			        //Swap VFOs
-				
- 			        //Store values
- 			        store_frequency(f_vfo[0], 16); //VFO A
-			        store_frequency(f_vfo[1], 17); //VFO B
-			        if(cur_vfo)
-			        {
-			            cur_vfo = 0;
-			        }
-			        else
-			        {
-			            cur_vfo = 1;
-			        }
-			       
-			        show_vfo(cur_vfo, split);
-			        set_frequency1(f_vfo[cur_vfo]);
-			        show_frequency(f_vfo[cur_vfo]);
-			        store_last_vfo(cur_vfo);
-			        key = 0;
-			        break;
- 		}	
-
-		//Show voltage every sec
-        if(runseconds10 > runseconds10e + 10)
-        {
-			volts0 = (double) get_adc(1) * 5 / 1024 * VOLTAGEFACTOR * 10; 
-		    volts1 = (int) volts0;
-   		    if(volts1 != volts1_old)
-		    {
-    	        show_voltage(volts1);
-	     		volts1_old = volts1;
-		    }	
-		    runseconds10e = runseconds10;
-		}   	
-		
-		//PA temp every sec
-		if(runseconds10 > runseconds10patemp + 10)
-        {
-			pa_temp = get_temp();
-			if(pa_temp != pa_temp_old)
-			{
-		        show_pa_temp(pa_temp);
-		        pa_temp_old = pa_temp;
-		    }    
-		    runseconds10patemp = runseconds10;
-		}    
-		
-		//METER
-		//After 1/10th sec check S-Val resp. PWR value
-		if(runseconds10 > runseconds10c)
-		{
-			if(!txrx)
-		 	{
-				show_meter(get_adc(2)); //S-Meter * 1
-		 	}
-		 	else
-		 	{
-				adcval = get_adc(3);
-				show_meter((adcval >> 1)); //*0.5
-			}    
- 		 	runseconds10c = runseconds10;
- 		}	
-		
-		//Sideband detection via PORTD (PD1);
-		if(!(PIND & (1 << PD1)))
-		{
-			sideband = 1;
-			set_frequency1(f_vfo[cur_vfo]);    		 
-	        show_frequency(f_vfo[cur_vfo]);    		
-		}		
-		else
-		{
-			sideband = 0;
-			set_frequency1(f_vfo[cur_vfo]);    		 
-	        show_frequency(f_vfo[cur_vfo]);    		
-		}		
-		
-		if(sideband_old != sideband)
-		{
-		    set_frequency2(f_lo[sideband]);
-			sideband_old = sideband;
-			show_sideband(sideband, 0);
-		}
-		
-		//TX/RX detection via PORTD (PD0);
-		if(!(PIND & (1 << PD0)))
-		{
-			txrx = 0;
-		}		
-		else
-		{
-			txrx = 1;
-		}		
-				
-		if(txrx_old != txrx) //PTT switched
-		{
-		    show_meter_scale(txrx);
-		    txrx_old = txrx;
-		    show_meter(0);
-		    
-		    //Set frequency if SPLIT activated
-		    if(split)
-		    {
-		        if(txrx)
-		        {
-		            cur_vfo = vfo_y;       // TX
-			        
-			    }
-		        else	
-		        {
-			        cur_vfo = vfo_x;       // RX    
-			    }   
-			    show_vfo(cur_vfo, split);
-			    set_frequency1(cur_vfo);
-			    show_frequency(cur_vfo);    
-			         
-			}
-		}
-				
-		//Store VFO data every 10 minutes
-		if(runseconds10 > runseconds10b + 6000)
-		{
-			store_vfo_data(cur_vfo, f_vfo[0], f_vfo[1]);
-			lcd_putchar1(13 * 6, 1, '.', 0);
-			runseconds10b = runseconds10;
-		}
-		
-		//Delete max value of meter every 2 seconds
-		if(runseconds10 > runseconds10s + 20)
-		{
-			reset_smax();
-			show_meter(get_adc(2));			
-			
-		}	
-		
-		if(runseconds10 > runseconds10sc + 5)
-		{
-			lcd_putchar1(13 * 6, 4, '*', 0);
-		}	
-		else
-		{
-			lcd_putchar1(13 * 6, 4, '.', 0);
-		}	
-		
-		if(runseconds10 > runseconds10sc + 10)
-		{
-			runseconds10sc = runseconds10;
-			lcd_putchar1(13 * 6, 4, ' ', 0);
-		}	
-		
-		//Reset all timer variables
-		if(runseconds10 > 16777216)
- 		{
-			runseconds10 = 0;
-		    runseconds10e = 0;
-            runseconds10key = 0;
-            runseconds10patemp = 0;
-            runseconds10sc = 0;
-    	}	
-		
-    }
-    return 0;
-}
+////////////////////////////////////////////////////////////////////
+//     20m HiPerformance TRX with ATMega664P and AD9951 as VFO    //
+//            and AD9834 as LO, LCD: Nokia 5110                   //
+////////////////////////////////////////////////////////////////////
+//  Microcontroller:                                              //
+//  ATMEL AVR ATmega644P 16 MHz with ext. resonator               //
+//  EESAVE fuse activated, JTAG off                               //
+//  Fuses for ATMega644p: E:FF, H:D1, L:FF                        //
+//  -U lfuse:w:0xff:m -U hfuse:w:0xd1:m -U efuse:w:0xff:m         // 
+////////////////////////////////////////////////////////////////////
+//  Compiler:         GCC (GNU AVR C-Compiler)                    //
+//  Author:           Peter Rachow  DK7IH                         //
+//  Last Change: 2019-06-21                                       //
+////////////////////////////////////////////////////////////////////
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "hal.h"
+//////////////////////////////////////////////////
+ 
+//Port usage  
+//O U T P U T 
+
+//DDS1
+//IO_UD:       PB0 (1) (green)  
+//SDIO (DATA): PB1 (2) (white)
+//SCLK         PB2 (4) (blue)
+//RESET        PB3     (violet)
+ 
+//DDS2
+//FSYNC:       PC0 (1) (green)  
+//SDIO (DATA): PC1 (2) (white)
+//SCLK         PC2 (4) (blue)
+//RESET        PC3  (pink)
+
+//LCD
+//RES:  PD4
+//DC:   PD5
+//DIN:  PD6
+//SCLK: PD7
+
+// I N P U T
+//PD0: TX/RX detect
+//PD1 sideband switch
+//PD2, PD3: Rotary encoder
+
+//ADC
+//ADC Channels
+//PA0 - ADC0: 4 user keys in front panel
+//PA1 - ADC1: voltage measurement voltage divider
+//PA2 - ADC2: S-meter from AGC voltage
+//PA3 - ADC3: TX PWR meter
+//PA4 - ADC4: Temp. sensor PA
+
+//  EEPROM  //////////////////////////////////////////////////
+// Bytes
+// 0:63: Memory frequencies of MEM 0:15 in blocks by 4 bytes (old format, copied to bank once)
+// 64:67: Freq VFO A memplace=16
+// 68:71: Freq VFO B memplace=17
+// 127: Last memory selected
+// 128: Last VFO in use
+// 129: Scan threshold (0:80)
+// 132:135: scanfreq[0] on memplace=33
+// 136:139: scanfreq[1] on memplace=34
+// 140:143: f_lo[0] on memplace=35
+// 144:147: f_lo[1] on memplace=36
+// 148:149: Voltage calibration factor * 1000
+// 150: Low voltage alarm in 1/10 V
+// 151: ADC noise reduction mode for S-meter (0, 1)
+// 152: Tuning acceleration curve
+// 153: Band scan step size (index in scan_step_hz[])
+// 154: Band scan resume policy
+// 155: Scan hit log saved to EEPROM (0, 1)
+// 156: Priority channel memory (255: none)
+// 157: Dual watch (0, 1)
+// 255: Memory bank format marker
+// 256:1255: Memory bank, 100 records by 10 bytes
+//           +0:+3 frequency (MSB first), +4 flags, +5:+9 label
+// 1344:1599: Scan hit log, see HITLOG_EEP_ADR
+// 1600:1663: Band scan exclusion ranges, see EXCL_EEP_ADR
+//////////////////////////////////////////////////////////////
+
+#define VOLTAGEFACTOR 4600 //Default const for voltage calculation * 1000
+
+#undef F_CPU
+#define F_CPU 16000000
+#define INTERFREQUENCY 9000000
+
+// SPI DDS1 (AD9951)
+#define DDS1_PORT PORTB
+#define DDS1_IO_UD 1      //PB0
+#define DDS1_SDIO 2       //PB1
+#define DDS1_SCLK 4       //PB2
+#define DDS1_RESETPIN 3   //PB3
+
+//  SPI DDS2 (AD9834)
+#define DDS2_PORT PORTC 
+#define DDS_FSYNC 1
+#define DDS_SDATA 2
+#define DDS_SCLK 4
+#define DDS2_RESETPIN 3
+ 
+// PORT definitions Nokia 5110 LCD
+#define LCD_PORT PORTD
+#define RES 16       //PD4
+#define DC 32        //PD5
+#define DN 64        //PD6
+#define LCDSCLK 128  //PD7
+
+//LCD
+#define FONTWIDTH 6
+
+//PA temperature table
+#include "kty81.h"
+
+////////////////////////
+// F U N C T I O N S  //
+////////////////////////
+int main(void);
+
+//Modal screens, state machines stepped by task_keys() and task_tuning()
+//while the scheduler keeps running the other tasks. Screens with live data
+//get ticks from task_screen() too, a tick is a step with key and steps 0.
+#define SCREENS 19
+#define SCR_NONE -1         //Main display
+#define SCR_MENU 0
+#define SCR_RECALL 1
+#define SCR_STORE 2
+#define SCR_LO 3
+#define SCR_THRESH 4
+#define SCR_SCANF 5
+#define SCR_VCAL 6
+#define SCR_VALARM 7
+#define SCR_VSTATS 8
+#define SCR_ADCNR 9
+#define SCR_ACCEL 10
+#define SCR_SCANCFG 11
+#define SCR_HITS 12
+#define SCR_TASKS 13
+#define SCR_LATENCY 14
+#define SCR_TUNLAT 15
+#define SCR_PROFILE 16
+#define SCR_LABEL 17
+#define SCR_SCOPE 18
+typedef int (*screen_fn)(int, int); //Key, encoder steps, returns 1 when done
+void screen_open(int);
+void screen_input(int, int);
+void screen_close(void);
+
+//Menu, descriptor tables in flash
+#define MENUS 7
+#define MENU_ITEMS 5
+#define MENU_TEXTLEN 7
+#define MENU_END -1
+typedef void (*menu_fn)(void);
+void menux(void);
+int menu_step(int, int);
+void menu_show(int);
+void menu_run(int, int);
+void print_menu_head(int);
+void print_menu_item(int, int, int);
+void print_menu_item_list(int, int, int);
+void menu_copy(char*, const __flash char*);
+void menu_vfo_a(void);
+void menu_vfo_b(void);
+void menu_a_to_b(void);
+void menu_b_to_a(void);
+void menu_scope(void);
+void menu_recall(void);
+void menu_store(void);
+void menu_label(void);
+void menu_prio(void);
+void menu_scan_mem(void);
+void menu_scan_band(void);
+void menu_scan_limits(void);
+void menu_split_on(void);
+void menu_split_off(void);
+void menu_dw_on(void);
+void menu_dw_off(void);
+void menu_lo_usb(void);
+void menu_lo_lsb(void);
+void menu_lo_reset(void);
+
+//Scanning & VFO
+long scan(int);
+void set_scan_threshold(void);
+int scan_threshold_step(int, int);
+void set_scan_frequency(int, long);
+int scan_frequency_step(int, int);
+int get_tuning_steps(void);
+long get_tuning_hz(unsigned int*);
+int wrap_step(int, int, int);
+int limit_step(int, int, int, int, int);
+int set_vfo(int, int);
+
+//Band scan dwells SCAN_SETTLE + SCAN_DWELL S-meter samples (0.5ms each) per step,
+//SCAN_DWELL_LONG if the value is within SCAN_NEAR of s_threshold
+#define SCAN_STEPS 6                //Selectable step sizes
+#define SCAN_SETTLE 2               //Samples discarded after DDS step (IF filter, AGC)
+#define SCAN_DWELL 4
+#define SCAN_DWELL_LONG METER_OVERSAMPLE
+#define SCAN_NEAR 4
+#define SCAN_SHOW_MS 200            //Display update while stepping
+#define SCAN_MSG_MS 1000            //Message on row 5, scan goes on meanwhile
+#define SCAN_HANG_MS 2000           //Resume after signal has gone for this time
+#define SCAN_HOLD_MS 5000           //Resume after this time with SCAN_RESUME_TIME
+#define SCAN_RESUME_CARRIER 0       //Resume policies
+#define SCAN_RESUME_TIME 1
+#define SCAN_RESUME_HOLD 2
+#define SCAN_RESUMES 3
+#define SCAN_EXCLUDE (KEY_EV_LONG | 4) //scan_hold(): key 4 held, exclude the frequency
+int scan_dwell(void);
+int scan_hold(long, int);
+void set_scan_config(void);
+int scan_config_step(int, int);
+
+//Bandscope, sweep of SCOPE_BINS steps of scan_step_hz[scope_span] around the VFO,
+//one bin per LCD column, bars in rows 1..5
+#define SCOPE_BINS 84
+#define SCOPE_ROWS 5
+#define SCOPE_FULL 55               //S-value of full bar, same scale as S-meter
+void bandscope(long);
+int bandscope_step(int, int);
+void scope_start(long);
+int scope_height(int);
+unsigned char scope_byte(int);
+void scope_column(int, int, int, int);
+void scope_head(long, int);
+
+//Scan hit log, ring of the last HITLOG_LEN stops on a signal: frequency, peak S-value,
+//dwell and time of stop in 1/10 s since power on. With hitlog_eep set it is written
+//to EEPROM when the scan ends, never while it runs (a record takes 11 byte writes).
+//Of a scan with more than HITLOG_LEN hits only the newest HITLOG_LEN are saved.
+#define HITLOG_LEN 16
+#define HITLOG_EEP_ADR 1344  //'H', 'L', next record, records in use, then HITLOG_EEP_LEN records
+#define HITLOG_EEP_LEN 22
+#define HITREC_SIZE 11       //f (4 bytes), t (4), dwell (2), S (1)
+void hitlog_add(long, int, unsigned long);
+void hitlog_flush(void);
+void hitlog_load(void);
+void show_hit_log(void);
+int hit_log_step(int, int);
+
+//Priority channel is looked at every PRIO_EVERY_MEM or PRIO_EVERY_BAND steps of scan(),
+//dual watch looks at the other VFO every DUAL_PERIOD ms while the current one is quiet
+//and switches over if it is busy. A look is one DDS write of a cached FTW and
+//PRIO_SAMPLES S-meter samples.
+#define PRIO_EVERY_MEM 4
+#define PRIO_EVERY_BAND 50
+#define PRIO_SAMPLES 1
+#define DUAL_PERIOD 200      //ms
+#define FTW_SLOTS 3          //Cached FTWs of VFO A, VFO B and priority channel
+#define FTW_PRIO 2
+unsigned long ftw_cached(int, unsigned long);
+void dds1_hop(unsigned long);
+int look_at(unsigned long);
+int prio_look(int);
+int prio_hold(int);
+void set_prio_mem(int);
+
+//Band scan exclusion ranges (birdies, busy channels), sorted and disjoint. In EEPROM
+//at EXCL_EEP_ADR: count, then lower and upper frequencies from EXCL_EEP_ADR + 4.
+#define EXCL_MAX 7
+#define EXCL_EEP_ADR 1600
+#define EXCL_WIDTH 2500      //Hz above a stop excluded by holding key 4, about the IF passband
+void excl_load(void);
+void excl_store(void);
+int excl_add(long, long);
+long excl_skip(long, long, int*);
+
+//Tuning acceleration, encoder steps are timestamped in 64us ticks
+#define ACCEL_CURVES 3
+#define ACCEL_LEN 5                 //Points per curve
+#define ACCEL_MS(ms) ((ms) * 125L / 8) //ms to fine ticks
+#define ENC_PERIOD_MAX 0x3FFF       //Longest step period measured (1.05s)
+unsigned int get_fine_ticks(void);
+unsigned int accel_step_hz(unsigned int);
+void set_tuning_accel(void);
+int tuning_accel_step(int, int);
+
+//Clock, Timer1 in CTC mode interrupts every ms
+#define CLOCK_TOP 249               //OCR1A, 16MHz / 64 / (249 + 1) = 1kHz
+unsigned long get_clock_ms(void);
+unsigned long get_clock_ticks(void);
+unsigned long clock_since(unsigned long);
+int clock_due(unsigned long*, unsigned long);
+
+//Profiling build (make PROFILE=1): calls, total and max run time of hot functions
+//in clock ticks (4us = 64 cycles), inclusive of callees and interrupts. A call counts
+//the tick edges it spans, 0 or 1 for calls shorter than a tick, so max is good to one
+//tick and the average over many calls to a fraction of one.
+#define PROF_FUNCS 8
+#define PROF_TICK_CYCLES 64 //Timer1 prescaler
+#define PROF_EEP_ADR 1792   //Dump in EEPROM: 'P', 'F', PROF_FUNCS, PROF_TICK_CYCLES, calls[], total[], max[]
+#ifdef PROFILE
+#define PROF_SET_FREQUENCY1 0
+#define PROF_SET_FREQUENCY2 1
+#define PROF_LCD_SENDBYTE 2
+#define PROF_LCD_PUTCHAR2 3
+#define PROF_GET_ADC 4
+#define PROF_INT2ASC 5
+#define PROF_STORE_FREQUENCY 6
+#define PROF_SHOW_METER 7
+#define PROF_BEGIN unsigned long prof_t0 = get_clock_ticks()
+#define PROF_END(n) prof_record(n, prof_t0)
+void prof_record(int, unsigned long);
+#else
+#define PROF_BEGIN
+#define PROF_END(n)
+#endif
+void prof_init(void);
+void prof_dump(void);
+void show_profile(void);
+int profile_step(int, int);
+
+//Benchmark build (make bench): cycle counts of core functions, taken by bench_sim under simavr
+#ifdef BENCH
+#include "bench.h"
+#define BENCH_REPEAT 3
+#define BENCH_RUN(id, call) do { hal_bench_id(id); hal_bench_mark(BENCH_MARK_START); call; hal_bench_mark(BENCH_MARK_STOP); } while(0)
+void bench_run(void);
+#endif
+
+//SPI for DDS1
+#define DDS1_FTW_K 180143985UL  //2^32 / 400MHz * 2^24
+void spi1_send_bit1(int);
+void spi1_send_byte1(unsigned int);
+void spi1_send_word1(unsigned int);
+unsigned long calc_ftw1(unsigned long, int);
+void dds1_send_ftw(unsigned long);
+void set_frequency1(long);
+void set_vfo_frequency(unsigned long, long, unsigned int);
+
+//SPI for DDS2
+#define DDS2_FTW_K 960767921UL  //2^28 / 75MHz * 2^28
+void spi2_start(void);
+void spi2_send_bit(int);
+void spi2_stop(void);
+unsigned long calc_ftw2(unsigned long);
+void dds2_send_ftw(unsigned long);
+void set_frequency2(unsigned long);
+
+//PTT (PD0) and sideband switch (PD1), edges are taken in pin change ISR
+//and switch the DDS at once. Further edges are ignored for PIN_DEBOUNCE ms,
+//then the clock ISR catches up with the settled state.
+#define PIN_MASK ((1 << PD0) | (1 << PD1))
+#define PIN_DEBOUNCE 10
+void pin_init(void);
+void pin_update(void);
+void pin_fast_path(unsigned char);
+void dds_catch_up(void);
+
+//LO setting
+void set_lo_freq(int);
+int lo_freq_step(int, int);
+
+//STRING FUNCTIONS
+int int2asc(long, int, char*, int);
+int strlen(char *);
+
+//SPI for LCD
+void lcd_sendbyte(char, int);
+void lcd_senddata(char);
+void lcd_sendcmd(char);
+void lcd_reset(void);
+void lcd_gotoxy(char, char);
+void lcd_cleanram(void);
+int xp2(int);
+void lcd_putchar2(int, int, char, int);
+void lcd_putchar1(int, int, char, int);
+void lcd_putstring(int, int, char*, char, int);
+void lcd_putnumber(int, int, long, int, int, int);
+void lcd_init(void);
+void lcd_clearsection(int, int, int);
+void lcd_cls(int, int, int, int);
+void lcd_drawbox(int, int, int, int);
+
+//DATA DISPLAY ROUTINES
+void show_frequency(unsigned long);
+void show_frequency2(unsigned long);
+void show_voltage(int);
+void show_meter(int);
+void reset_smax(void);
+void show_sideband(int, int);
+void show_mem_addr(int, int);
+void show_mem_freq(unsigned long, int);
+void show_pa_temp(int);
+void show_vfo(int, int);
+void show_all_data(unsigned long, int, int, int, int, int);
+void show_meter_scale(int);
+
+//Supply voltage
+void measure_voltage(void);
+void reset_volt_stats(void);
+void set_volt_cal(void);
+int volt_cal_step(int, int);
+void set_volt_alarm(void);
+int volt_alarm_step(int, int);
+void show_volt_stats(void);
+int volt_stats_step(int, int);
+
+//Task scheduler, tasks in table in order of priority
+#define TASKS 12
+typedef void (*task_fn)(void);
+void task_init(void);
+void task_run(int);
+int run_tasks(void);
+void show_task_stats(void);
+int task_stats_step(int, int);
+void task_tuning(void);
+void task_txrx(void);
+void task_keys(void);
+void task_screen(void);
+void task_sideband(void);
+void task_meter(void);
+void task_smax(void);
+void task_blink(void);
+void task_volt(void);
+void task_patemp(void);
+void task_autosave(void);
+void task_dualwatch(void);
+
+//Events posted by ISRs, main loop sleeps in idle mode while none is pending
+#define EV_ENC 0x01       //Encoder step
+#define EV_PIN 0x02       //PTT or sideband switch changed
+#define EV_KEY 0x04       //Key event queued
+#define EV_TICK 0x08      //Clock, every ms
+#define EV_STAMPED 3      //Events 0x01..0x04 get a time stamp for latency measurement
+void post_event(unsigned char);
+unsigned char take_events(unsigned long*);
+void event_latency(unsigned char, unsigned long*);
+void idle_sleep(void);
+void show_latency(void);
+int latency_step(int, int);
+
+//Tuning latency from 1st detent (INT0/INT1) to IO_UD strobe of DDS1 in set_frequency1(),
+//histogram of 4us ticks in log2 buckets: bucket n holds 2^(n-1) <= ticks < 2^n
+#define TLAT_BUCKETS 16     //Last bucket takes all from 65ms
+#define TLAT_EEP_ADR 1920   //Dump in EEPROM: 'T', 'L', TLAT_BUCKETS, 0, count, max, hist[]
+void tlat_record(void);
+void tlat_init(void);
+void tlat_dump(void);
+void show_tuning_latency(void);
+int tuning_latency_step(int, int);
+
+//ADC
+//ADC Channels
+//ADC0: keys
+//ADC1: voltage
+//Conversions are triggered by Timer0 every ADC_TICK, ADC ISR walks thru adc_schedule[]
+#define ADC_CHANNELS 5
+#define ADC_TICK 61          //OCR0A, 16MHz / 64 / (61 + 1) = 4032 conversions per s
+#define ADC_SCHEDULE_LEN 16
+void adc_init(void);
+int get_adc(int);
+
+//Meter channels ADC2 (S) and ADC3 (PWR) are oversampled and decimated
+#define METER_OVERSAMPLE 16  //Samples per decimated value
+#define METER_ATTACK 0       //Smoothing shifts for rising and falling values, 0 = off
+#define METER_DECAY 2
+void meter_sample(int, int);
+int get_meter(int);
+int get_meter_fresh(int);
+int get_meter_quick(int);
+void meter_restart(int);
+
+//Optional S-meter sampling in ADC noise reduction sleep mode,
+//CPU and I/O clock are halted while ADC2 converts
+#define ADC_NR_DIV 4          //1 NR sample per ADC_NR_DIV ADC2 slots in schedule
+#define ADC_NR_CYCLES 1664    //CPU cycles Timer1 stands still per NR sample (13 * 128)
+#define ADC2_STAT_N 32        //Samples per variance window
+void adc_nr_sample(void);
+void adc2_stat(int);
+void set_adc_nr(void);
+int adc_nr_step(int, int);
+int get_keys(void);
+
+//Keypad scanner, runs on each ADC0 sample (every 2ms) in ADC ISR
+#define KEY_DEBOUNCE 4         //Equal samples until key state changes
+#define KEY_LONG_TIME 400      //Samples until long press event (0.8s)
+#define KEY_REPEAT_TIME 75     //Samples between repeat events (0.15s)
+#define KEY_QUEUE_LEN 8
+#define KEY_EV_PRESS 0x10      //Key events: Key number (1..4) + type
+#define KEY_EV_RELEASE 0x20
+#define KEY_EV_LONG 0x40
+#define KEY_EV_REPEAT 0x80     //Only while key_repeat is set
+int decode_key(int);
+void keypad_scan(int);
+void push_key_event(int);
+int get_key_event(void);
+int get_key_input(int);
+int get_key_press(void);
+void flush_key_events(void);
+int get_temp(void);
+
+//EEPROM and frequency storage
+#define MAXMEM 99           //Highest memory number (100 channels)
+#define MEMBANK_ADR 256     //Start of memory bank in EEPROM
+#define MEMBANK_MARK_ADR 255
+#define MEMBANK_MARK 0xA5   //Bank has been initialized
+#define MEMRECSIZE 10       //Bytes per memory record
+#define MEMLABELLEN 5       //Chars of label per memory
+#define MEMFLAG_LSB 1       //Flags byte of memory record
+#define MEMFLAG_SKIP 2
+void store_frequency(long, int);
+unsigned long load_frequency(int);
+void store_frequency_adr(long, int);
+unsigned long load_frequency_adr(int);
+int is_mem_freq_ok(unsigned long);
+void store_last_mem(int);
+int load_last_mem(void);
+void store_last_vfo(int);
+int load_last_vfo(void);
+void store_vfo_data(int, unsigned long, unsigned long);
+
+//Memory bank
+unsigned long load_mem_freq(int);
+int load_mem_flags(int);
+void load_mem_label(int, char*);
+void store_mem(int, unsigned long, int, char*);
+void store_mem_flags(int, int);
+void store_mem_label(int, char*);
+void init_mem_bank(void);
+void mem_index_insert(int);
+void mem_index_remove(int);
+void build_mem_index(void);
+int find_nearest_mem(unsigned long);
+int mem_locked(int);
+
+void recall_mem_freq(unsigned long);
+int recall_step(int, int);
+void save_mem_freq(long, int);
+int store_step(int, int);
+void edit_mem_label(int);
+int mem_label_step(int, int);
+void show_mem_info(int);
+
+//////////////////////////
+//   V A R I A B L E S
+//////////////////////////
+//Rotray encoder
+//Quadrature transitions (old state PD3:PD2 << 2 | new state) to quarter steps
+static const __flash signed char enc_table[16] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
+volatile unsigned char enc_state = 0;   //Last state of PD3:PD2
+volatile signed char enc_sub = 0;       //Quarter steps not yet counted
+volatile int enc_count = 0;             //Steps not yet consumed, CW < 0 < CCW
+
+//Tuning acceleration
+//Step period (upper limit in fine ticks) and tuning step in Hz per curve
+//Steps of 10Hz and more snap the VFO to a grid of that size
+static const __flash unsigned int accel_curve[ACCEL_CURVES][ACCEL_LEN][2] = 
+                              {{{ENC_PERIOD_MAX, 2}, {ENC_PERIOD_MAX, 2}, {ENC_PERIOD_MAX, 2}, {ENC_PERIOD_MAX, 2}, {ENC_PERIOD_MAX, 2}},                          //OFF
+                               {{ENC_PERIOD_MAX, 2}, {ACCEL_MS(40), 10}, {ACCEL_MS(20), 100}, {ACCEL_MS(10), 1000}, {ACCEL_MS(5), 1000}},    //SOFT
+                               {{ENC_PERIOD_MAX, 2}, {ACCEL_MS(60), 10}, {ACCEL_MS(30), 100}, {ACCEL_MS(15), 1000}, {ACCEL_MS(8), 5000}}};   //FAST
+char *accel_str[ACCEL_CURVES] = {"OFF ", "SOFT", "FAST"};
+int tune_accel = 1;                         //Selected curve
+volatile unsigned int enc_last_tick = 0;    //Time of last step
+volatile unsigned int enc_period = ENC_PERIOD_MAX; //Smoothed step period in fine ticks
+volatile signed char enc_dir = 0;           //Direction of last step
+volatile long enc_hz = 0;                   //Accelerated tuning not yet consumed
+volatile unsigned int enc_grid = 1;         //Largest step size in enc_hz
+
+//Clock
+volatile unsigned long clock_ms = 0;   //ms since start, wraps after 49 days
+
+//PTT and sideband switch
+volatile unsigned char pin_state;      //Debounced state of PD0 and PD1
+volatile unsigned long pin_time[2];    //Time of last accepted edge (ms)
+volatile unsigned char dds_busy = 0;   //Main is transferring to a DDS
+volatile unsigned char dds_redo = 0;   //Fast path was held off meanwhile
+volatile unsigned char dds_peek = 0;   //DDS1 is parked off the VFO by dual watch or bandscope
+
+//Tuning
+unsigned long f_vfo[2];
+volatile int cur_vfo = 0;      //VFO, split and TX state is also switched by pin change ISR
+volatile int split = 0;
+volatile int vfo_x, vfo_y;
+volatile int txrx = 0;
+
+//LO settings
+long f_lo[] = {9000600, 8998200}; //USB, LSB
+volatile int sideband = 0; //Sets sideband to USB	
+
+//MEMORY
+int last_memplace = 0;
+int last_mem = 0; //Stored in Byte ( 4 * 16 + 1) = 65
+
+//Channel numbers of valid memories sorted by frequency
+unsigned char mem_index[MAXMEM + 1];
+int mem_count = 0;
+unsigned char mem_lock[(MAXMEM >> 3) + 1]; //MEMFLAG_SKIP of each memory, 1 bit per memory
+char *mem_label_chars = " ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-/.";
+
+//Scanning
+int s_threshold = 30;
+long scanfreq[2];
+static const __flash unsigned int scan_step_hz[SCAN_STEPS] = {100, 250, 500, 1000, 2500, 5000};
+char *scan_resume_str[SCAN_RESUMES] = {"CARR", "TIME", "HOLD"};
+int scan_step = 0;                       //Index in scan_step_hz[]
+int scan_resume = SCAN_RESUME_CARRIER;
+unsigned char scope_val[SCOPE_BINS];     //S-value of each bin of the last sweep
+int scope_span = 1;                      //Bin width, index in scan_step_hz[]
+
+//Scan hit log
+unsigned long hit_f[HITLOG_LEN];
+unsigned long hit_t[HITLOG_LEN];         //1/10 s
+unsigned int hit_dwell[HITLOG_LEN];      //1/10 s
+unsigned char hit_s[HITLOG_LEN];
+unsigned char hit_pos = 0;               //Next record
+unsigned char hit_count = 0;             //Records in use
+unsigned char hit_unsaved = 0;           //Newest records not yet in EEPROM
+unsigned char hit_prev = 0;              //Oldest records, loaded from an earlier power on
+int hitlog_eep = 0;
+char *hit_head[3] = {" HITS  S PEAK ", " HITS  DWELL S", " HITS  T MIN  "};
+
+//Priority channel and dual watch
+int prio_mem = -1;                       //Memory of priority channel, -1: none
+unsigned long prio_f = 0;
+int prio_n = 0;                          //Scan steps since last look
+int dual_watch = 0;
+unsigned long ftw_f[FTW_SLOTS];          //Frequency and sideband the cached FTW is for
+unsigned char ftw_sb[FTW_SLOTS];
+unsigned long ftw_val[FTW_SLOTS];
+
+//Band scan exclusion ranges
+long excl_lo[EXCL_MAX];
+long excl_hi[EXCL_MAX];
+int excl_count = 0;
+
+//Supply voltage in 1/10 V, measured once per sample by measure_voltage()
+int voltage = 0;
+int volts_min, volts_max;
+unsigned int volts_avg16 = 0;  //Running average * 16
+unsigned int volt_cal = VOLTAGEFACTOR;
+int volt_alarm = 110;          //Low voltage alarm in 1/10 V
+
+//S-Meter max value
+int smax = 0;
+unsigned long time_smax = 0;
+
+//Menu tree, key 1 goes on to menu_next[], key 2 runs menu_action[] of the item
+static const __flash char menu_head[MENUS][2][MENU_TEXTLEN] = {{"VFO", ""}, {"MEMO", ""}, {"SCAN", ""}, {"SPLIT", "MODE"},
+	                                                           {"LO", "FREQ"}, {"SETUP", ""}, {"INFO", ""}};
+static const __flash char menu_text[MENUS][MENU_ITEMS][MENU_TEXTLEN] = {{"VFO A ", "VFO B ", "A=B   ", "B=A   ", "SCOPE "},
+		                                                                {"RECALL", "STORE ", "LABEL ", "PRIO  "}, 
+	                                                                    {"MEMORY", "BAND  ", "LIMITS", "THRESH", "CONFIG"},
+	                                                                    {"ON    ", "OFF   ", "DW ON ", "DW OFF"}, 
+	                                                                    {"USB   ", "LSB   ", "RESET "},
+	                                                                    {"VCAL  ", "VALARM", "VSTATS", "ADC NR", "ACCEL "},
+	                                                                    {"TASKS ", "LATENC", "PROFIL", "TUNLAT", "HITS  "}};
+static const __flash unsigned char menu_last[MENUS] = {4, 3, 4, 3, 2, 4, 4}; //Index of last item
+static const __flash signed char menu_next[MENUS] = {1, 2, 3, 4, 5, 6, MENU_END};
+static const __flash menu_fn menu_action[MENUS][MENU_ITEMS] = {{menu_vfo_a, menu_vfo_b, menu_a_to_b, menu_b_to_a, menu_scope},
+	                                                           {menu_recall, menu_store, menu_label, menu_prio},
+	                                                           {menu_scan_mem, menu_scan_band, menu_scan_limits, set_scan_threshold, set_scan_config},
+	                                                           {menu_split_on, menu_split_off, menu_dw_on, menu_dw_off},
+	                                                           {menu_lo_usb, menu_lo_lsb, menu_lo_reset},
+	                                                           {set_volt_cal, set_volt_alarm, show_volt_stats, set_adc_nr, set_tuning_accel},
+	                                                           {show_task_stats, show_latency, show_profile, show_tuning_latency, show_hit_log}};
+
+//Modal screens
+static const __flash screen_fn screen_func[SCREENS] = {menu_step, recall_step, store_step, lo_freq_step, 
+	                                                   scan_threshold_step, scan_frequency_step, volt_cal_step,
+	                                                   volt_alarm_step, volt_stats_step, adc_nr_step, tuning_accel_step,
+	                                                   scan_config_step, hit_log_step, task_stats_step, latency_step,
+	                                                   tuning_latency_step, profile_step, mem_label_step, bandscope_step};
+static const __flash unsigned char screen_coarse[SCREENS] = {0, 0, 0, 10, 10, 100}; //Knob steps per key 4 press or repeat
+static const __flash unsigned int screen_tick[SCREENS] = {0, 0, 0, 0, 0, 0, 100, 0, 500, 100, 0, 
+	                                                      0, 0, 500, 100, 100, 0, 0, 1}; //ms, 0: no ticks
+int screen = SCR_NONE;  //Open screen, gets keys and encoder steps
+int scr_arg;            //Menu, sideband, scan limit, memory, column resp. next bin of open screen
+int scr_pos;            //Selected item, memory, threshold, value, line, first line resp. cursor
+long scr_val;           //Frequency being edited, frequency of bin 0 of bandscope
+unsigned long scr_t;    //Last tick
+int scr_opt[4];         //Scan config being edited
+char scr_text[MEMLABELLEN + 1]; //Memory label being edited
+int scr_dir;            //Sign of last knob steps, direction of coarse steps
+
+//Task scheduler
+//Untimed tasks (period 0) run when one of their events is pending, then the first timed task that is due
+static const __flash task_fn task_func[TASKS] = {task_tuning, task_txrx, task_sideband, task_keys, task_screen, task_meter, 
+	                                             task_dualwatch, task_smax, task_blink, task_volt, task_patemp, task_autosave};
+static const __flash unsigned long task_period[TASKS] = {0, 0, 0, 0, 0, 100, DUAL_PERIOD, 100, 500, 1000, 1000, 600000}; //ms
+static const __flash unsigned char task_event[TASKS] = {EV_ENC, EV_PIN, EV_PIN, EV_KEY, EV_TICK, 0, 0, 0, 0, 0, 0, 0};
+char *task_name[TASKS] = {"TUNE", "PTT", "SB", "KEYS", "SCR", "METER", "DUALW", "SMAX", "BLINK", "VOLT", "TEMP", "SAVE"};
+unsigned long task_next[TASKS];      //Next release
+unsigned int task_miss[TASKS];       //Releases missed
+unsigned int task_late_max[TASKS];   //Max delay of start after release in ms
+unsigned int task_run_max[TASKS];    //Max run time in 4us ticks
+
+//Events
+volatile unsigned char events = 0;   //Pending events
+volatile unsigned long ev_stamp[EV_STAMPED]; //Clock ticks of first post since last take
+char *ev_name[EV_STAMPED] = {"ENC", "PIN", "KEY"};
+unsigned int ev_lat_max[EV_STAMPED]; //Max time from post to start of task in 4us ticks
+
+//Tuning latency
+volatile unsigned char tlat_pending = 0; //Detent stamped, not yet taken by task_tuning
+volatile unsigned long tlat_stamp;       //Clock ticks of 1st detent since last take
+unsigned char tlat_armed = 0;            //Next DDS1 update ends measurement
+unsigned long tlat_t0;
+unsigned int tlat_hist[TLAT_BUCKETS];
+unsigned long tlat_count = 0;
+unsigned long tlat_max = 0;              //Clock ticks
+
+//Profiling, order of PROF_ numbers, names are read by profile.py
+#ifdef PROFILE
+char *prof_name[PROF_FUNCS] = {"set_frequency1", "set_frequency2", "lcd_sendbyte", "lcd_putchar2", 
+	                           "get_adc", "int2asc", "store_frequency", "show_meter"};
+unsigned long prof_calls[PROF_FUNCS];
+unsigned long prof_total[PROF_FUNCS]; //Clock ticks
+unsigned long prof_max[PROF_FUNCS];
+#endif
+
+//ADC sequencer
+//Sampling schedule: 1 slot per ADC_TICK, S-meter every 0.5ms, PWR every 1ms,
+//keys every 2ms, voltage and PA temp every 4ms
+static const __flash unsigned char adc_schedule[ADC_SCHEDULE_LEN] = {2, 0, 2, 3, 2, 1, 2, 3, 2, 0, 2, 3, 2, 4, 2, 3};
+volatile int adc_slot[ADC_CHANNELS]; //Latest value of each channel
+volatile unsigned char adc_sched_pos = 0;
+
+//Keypad
+static const __flash int key_value[] = {86, 31, 50, 38}; //ADC0 values of keys 1..4
+volatile unsigned char key_raw = 0;      //Last decoded sample
+volatile unsigned char key_cnt = 0;      //Equal samples in a row
+volatile unsigned char key_state = 0;    //Debounced key
+volatile unsigned int key_hold = 0;      //Samples since press
+volatile unsigned char key_repeat = 0;   //Open screen wants repeat events
+volatile unsigned char key_queue[KEY_QUEUE_LEN];
+volatile unsigned char key_q_head = 0, key_q_tail = 0;
+
+//Meter pipeline, index 0: ADC2, 1: ADC3, values scaled by METER_OVERSAMPLE
+volatile unsigned int meter_acc[2];  //Accumulator of current block
+volatile unsigned char meter_n[2];   //Samples in current block
+volatile unsigned int meter_dec[2];  //Last decimated value
+volatile unsigned int meter_filt[2]; //Smoothed value
+volatile unsigned char meter_seq[2]; //Counts decimated values
+
+//ADC noise reduction mode
+int adc_nr_mode = 0;
+volatile unsigned char adc_nr_due = 0;    //ADC2 slots skipped since last NR sample
+volatile unsigned char adc_nr_active = 0; //NR conversion running
+unsigned int adc_nr_lost = 0;             //CPU cycles of Timer1 to catch up
+
+//Variance of ADC2 samples over ADC2_STAT_N samples
+volatile unsigned char adc2_stat_n = 0;
+volatile unsigned long adc2_stat_sum = 0, adc2_stat_sq = 0;
+volatile unsigned long adc2_var_d = 0;    //n * sum(x^2) - sum(x)^2 of last window
+volatile unsigned long adc2_mean_sum = 0; //sum(x) of last window
+
+// Font 6x8 for LCD Display Nokia 5110
+static const __flash char xchar[] = {
+0x00,0x00,0x00,0x00,0x00,0x00,	// 0x00
+0x00,0x3E,0x45,0x51,0x45,0x3E,	// 0x01
+0x00,0x3E,0x6B,0x6F,0x6B,0x3E,	// 0x02
+0x00,0x1C,0x3E,0x7C,0x3E,0x1C,	// 0x03
+0x00,0x18,0x3C,0x7E,0x3C,0x18,	// 0x04
+0x00,0x30,0x36,0x7F,0x36,0x30,	// 0x05
+0x00,0x18,0x5C,0x7E,0x5C,0x18,	// 0x06
+0x00,0x00,0x00,0x00,0x00,0x00,	// 0x07
+0x00,0x00,0x00,0x00,0x00,0x00,	// 0x08
+0x00,0x00,0x00,0x00,0x00,0x00,	// 0x09
+0x00,0x00,0x00,0x00,0x00,0x00,	// 0x0A
+0x00,0x30,0x48,0x4A,0x36,0x0E,	// 0x0B
+0x00,0x06,0x29,0x79,0x29,0x06,	// 0x0C
+0x00,0x00,0x00,0x00,0x00,0x00,	// 0x0D
+0x00,0x60,0x7E,0x0A,0x35,0x3F,	// 0x0E
+0x00,0x2A,0x1C,0x36,0x1C,0x2A,	// 0x0F
+0x00,0x00,0x7F,0x3E,0x1C,0x08,	// 0x10
+0x00,0x08,0x1C,0x3E,0x7F,0x00,	// 0x11
+0x00,0x14,0x36,0x7F,0x36,0x14,	// 0x12
+0x00,0x00,0x5F,0x00,0x5F,0x00,	// 0x13
+0x00,0x06,0x09,0x7F,0x01,0x7F,	// 0x14
+0x00,0x22,0x4D,0x55,0x59,0x22,	// 0x15
+0x00,0x60,0x60,0x60,0x60,0x00,	// 0x16
+0x00,0x14,0xB6,0xFF,0xB6,0x14,	// 0x17
+0x00,0x04,0x06,0x7F,0x06,0x04,	// 0x18
+0x00,0x10,0x30,0x7F,0x30,0x10,	// 0x19
+0x00,0x08,0x08,0x3E,0x1C,0x08,	// 0x1A
+0x00,0x08,0x1C,0x3E,0x08,0x08,	// 0x1B
+0x00,0x78,0x40,0x40,0x40,0x40,	// 0x1C
+0x00,0x08,0x3E,0x08,0x3E,0x08,	// 0x1D
+0x00,0x30,0x3C,0x3F,0x3C,0x30,	// 0x1E
+0x00,0x03,0x0F,0x3F,0x0F,0x03,	// 0x1F
+0x00,0x00,0x00,0x00,0x00,0x00,	// 0x20
+0x00,0x00,0x06,0x5F,0x06,0x00,	// 0x21
+0x00,0x07,0x03,0x00,0x07,0x03,	// 0x22
+0x00,0x24,0x7E,0x24,0x7E,0x24,	// 0x23
+0x00,0x24,0x2B,0x6A,0x12,0x00,	// 0x24
+0x00,0x63,0x13,0x08,0x64,0x63,	// 0x25
+0x00,0x36,0x49,0x56,0x20,0x50,	// 0x26
+0x00,0x00,0x07,0x03,0x00,0x00,	// 0x27
+0x00,0x00,0x3E,0x41,0x00,0x00,	// 0x28
+0x00,0x00,0x41,0x3E,0x00,0x00,	// 0x29
+0x00,0x08,0x3E,0x1C,0x3E,0x08,	// 0x2A
+0x00,0x08,0x08,0x3E,0x08,0x08,	// 0x2B
+0x00,0x00,0xE0,0x60,0x00,0x00,	// 0x2C
+0x00,0x08,0x08,0x08,0x08,0x08,	// 0x2D
+0x00,0x00,0x60,0x60,0x00,0x00,	// 0x2E
+0x00,0x20,0x10,0x08,0x04,0x02,	// 0x2F
+0x00,0x3E,0x41,0x49,0x41,0x3E,	// 0x30
+0x00,0x00,0x42,0x7F,0x40,0x00,	// 0x31
+0x00,0x62,0x51,0x49,0x49,0x46,	// 0x32
+0x00,0x22,0x49,0x49,0x49,0x36,	// 0x33
+0x00,0x18,0x14,0x12,0x7F,0x10,	// 0x34
+0x00,0x2F,0x49,0x49,0x49,0x31,	// 0x35
+0x00,0x3C,0x4A,0x49,0x49,0x30,	// 0x36
+0x00,0x01,0x71,0x09,0x05,0x03,	// 0x37
+0x00,0x36,0x49,0x49,0x49,0x36,	// 0x38
+0x00,0x06,0x49,0x49,0x29,0x1E,	// 0x39
+0x00,0x00,0x6C,0x6C,0x00,0x00,	// 0x3A
+0x00,0x00,0xEC,0x6C,0x00,0x00,	// 0x3B
+0x00,0x08,0x14,0x22,0x41,0x00,	// 0x3C
+0x00,0x24,0x24,0x24,0x24,0x24,	// 0x3D
+0x00,0x00,0x41,0x22,0x14,0x08,	// 0x3E
+0x00,0x02,0x01,0x59,0x09,0x06,	// 0x3F
+0x00,0x3E,0x41,0x5D,0x55,0x1E,	// 0x40
+0x00,0x7E,0x11,0x11,0x11,0x7E,	// 0x41
+0x00,0x7F,0x49,0x49,0x49,0x36,	// 0x42
+0x00,0x3E,0x41,0x41,0x41,0x22,	// 0x43
+0x00,0x7F,0x41,0x41,0x41,0x3E,	// 0x44
+0x00,0x7F,0x49,0x49,0x49,0x41,	// 0x45
+0x00,0x7F,0x09,0x09,0x09,0x01,	// 0x46
+0x00,0x3E,0x41,0x49,0x49,0x7A,	// 0x47
+0x00,0x7F,0x08,0x08,0x08,0x7F,	// 0x48
+0x00,0x00,0x41,0x7F,0x41,0x00,	// 0x49
+0x00,0x30,0x40,0x40,0x40,0x3F,	// 0x4A
+0x00,0x7F,0x08,0x14,0x22,0x41,	// 0x4B
+0x00,0x7F,0x40,0x40,0x40,0x40,	// 0x4C
+0x00,0x7F,0x02,0x04,0x02,0x7F,	// 0x4D
+0x00,0x7F,0x02,0x04,0x08,0x7F,	// 0x4E
+0x00,0x3E,0x41,0x41,0x41,0x3E,	// 0x4F
+0x00,0x7F,0x09,0x09,0x09,0x06,	// 0x50
+0x00,0x3E,0x41,0x51,0x21,0x5E,	// 0x51
+0x00,0x7F,0x09,0x09,0x19,0x66,	// 0x52
+0x00,0x26,0x49,0x49,0x49,0x32,	// 0x53
+0x00,0x01,0x01,0x7F,0x01,0x01,	// 0x54
+0x00,0x3F,0x40,0x40,0x40,0x3F,	// 0x55
+0x00,0x1F,0x20,0x40,0x20,0x1F,	// 0x56
+0x00,0x3F,0x40,0x3C,0x40,0x3F,	// 0x57
+0x00,0x63,0x14,0x08,0x14,0x63,	// 0x58
+0x00,0x07,0x08,0x70,0x08,0x07,	// 0x59
+0x00,0x71,0x49,0x45,0x43,0x00,	// 0x5A
+0x00,0x00,0x7F,0x41,0x41,0x00,	// 0x5B
+0x00,0x02,0x04,0x08,0x10,0x20,	// 0x5C
+0x00,0x00,0x41,0x41,0x7F,0x00,	// 0x5D
+0x00,0x04,0x02,0x01,0x02,0x04,	// 0x5E
+0x80,0x80,0x80,0x80,0x80,0x80,	// 0x5F
+0x00,0x00,0x03,0x07,0x00,0x00,	// 0x60
+0x00,0x20,0x54,0x54,0x54,0x78,	// 0x61
+0x00,0x7F,0x44,0x44,0x44,0x38,	// 0x62
+0x00,0x38,0x44,0x44,0x44,0x28,	// 0x63
+0x00,0x38,0x44,0x44,0x44,0x7F,	// 0x64
+0x00,0x38,0x54,0x54,0x54,0x08,	// 0x65
+0x00,0x08,0x7E,0x09,0x09,0x00,	// 0x66
+0x00,0x18,0xA4,0xA4,0xA4,0x7C,	// 0x67
+0x00,0x7F,0x04,0x04,0x78,0x00,	// 0x68
+0x00,0x00,0x00,0x7D,0x40,0x00,	// 0x69
+0x00,0x40,0x80,0x84,0x7D,0x00,	// 0x6A
+0x00,0x7F,0x10,0x28,0x44,0x00,	// 0x6B
+0x00,0x00,0x00,0x7F,0x40,0x00,	// 0x6C
+0x00,0x7C,0x04,0x18,0x04,0x78,	// 0x6D
+0x00,0x7C,0x04,0x04,0x78,0x00,	// 0x6E
+0x00,0x38,0x44,0x44,0x44,0x38,	// 0x6F
+0x00,0xFC,0x44,0x44,0x44,0x38,	// 0x70
+0x00,0x38,0x44,0x44,0x44,0xFC,	// 0x71
+0x00,0x44,0x78,0x44,0x04,0x08,	// 0x72
+0x00,0x08,0x54,0x54,0x54,0x20,	// 0x73
+0x00,0x04,0x3E,0x44,0x24,0x00,	// 0x74
+0x00,0x3C,0x40,0x20,0x7C,0x00,	// 0x75
+0x00,0x1C,0x20,0x40,0x20,0x1C,	// 0x76
+0x00,0x3C,0x60,0x30,0x60,0x3C,	// 0x77
+0x00,0x6C,0x10,0x10,0x6C,0x00,	// 0x78
+0x00,0x9C,0xA0,0x60,0x3C,0x00,	// 0x79
+0x00,0x64,0x54,0x54,0x4C,0x00,	// 0x7A
+0x00,0x08,0x3E,0x41,0x41,0x00,	// 0x7B
+0x00,0x00,0x00,0x77,0x00,0x00,	// 0x7C
+0x00,0x00,0x41,0x41,0x3E,0x08,	// 0x7D
+0x00,0x02,0x01,0x02,0x01,0x00,	// 0x7E
+0x00,0x3C,0x26,0x23,0x26,0x3C,	// 0x7F
+0x00,0x1E,0xA1,0xE1,0x21,0x12,	// 0x80
+0x00,0x3D,0x40,0x20,0x7D,0x00,	// 0x81
+0x00,0x38,0x54,0x54,0x55,0x09,	// 0x82
+0x00,0x20,0x55,0x55,0x55,0x78,	// 0x83
+0x00,0x20,0x55,0x54,0x55,0x78,	// 0x84
+0x00,0x20,0x55,0x55,0x54,0x78,	// 0x85
+0x00,0x20,0x57,0x55,0x57,0x78,	// 0x86
+0x00,0x1C,0xA2,0xE2,0x22,0x14,	// 0x87
+0x00,0x38,0x55,0x55,0x55,0x08,	// 0x88
+0x00,0x38,0x55,0x54,0x55,0x08,	// 0x89
+0x00,0x38,0x55,0x55,0x54,0x08,	// 0x8A
+0x00,0x00,0x01,0x7C,0x41,0x00,	// 0x8B
+0x00,0x00,0x01,0x7D,0x41,0x00,	// 0x8C
+0x00,0x00,0x01,0x7C,0x40,0x00,	// 0x8D
+0x00,0x70,0x29,0x24,0x29,0x70,	// 0x8E
+0x00,0x78,0x2F,0x25,0x2F,0x78,	// 0x8F
+0x00,0x7C,0x54,0x54,0x55,0x45,	// 0x90
+0x00,0x34,0x54,0x7C,0x54,0x58,	// 0x91
+0x00,0x7E,0x09,0x7F,0x49,0x49,	// 0x92
+0x00,0x38,0x45,0x45,0x39,0x00,	// 0x93
+0x00,0x38,0x45,0x44,0x39,0x00,	// 0x94
+0x00,0x39,0x45,0x44,0x38,0x00,	// 0x95
+0x00,0x3C,0x41,0x21,0x7D,0x00,	// 0x96
+0x00,0x3D,0x41,0x20,0x7C,0x00,	// 0x97
+0x00,0x9C,0xA1,0x60,0x3D,0x00,	// 0x98
+0x00,0x3D,0x42,0x42,0x3D,0x00,	// 0x99
+0x00,0x3C,0x41,0x40,0x3D,0x00,	// 0x9A
+0x80,0x70,0x68,0x58,0x38,0x04,	// 0x9B
+0x00,0x48,0x3E,0x49,0x49,0x62,	// 0x9C
+0x00,0x7E,0x61,0x5D,0x43,0x3F,	// 0x9D
+0x00,0x22,0x14,0x08,0x14,0x22,	// 0x9E
+0x00,0x40,0x88,0x7E,0x09,0x02,	// 0x9F
+0x00,0x20,0x54,0x55,0x55,0x78,	// 0xA0
+0x00,0x00,0x00,0x7D,0x41,0x00,	// 0xA1
+0x00,0x38,0x44,0x45,0x39,0x00,	// 0xA2
+0x00,0x3C,0x40,0x21,0x7D,0x00,	// 0xA3
+0x00,0x7A,0x09,0x0A,0x71,0x00,	// 0xA4
+0x00,0x7A,0x11,0x22,0x79,0x00,	// 0xA5
+0x00,0x08,0x55,0x55,0x55,0x5E,	// 0xA6
+0x00,0x4E,0x51,0x51,0x4E,0x00,	// 0xA7
+0x00,0x30,0x48,0x4D,0x40,0x20,	// 0xA8
+0x3E,0x41,0x5D,0x4B,0x55,0x3E,	// 0xA9
+0x04,0x04,0x04,0x04,0x04,0x1C,	// 0xAA
+0x00,0x17,0x08,0x4C,0x6A,0x50,	// 0xAB
+0x00,0x17,0x08,0x34,0x2A,0x78,	// 0xAC
+0x00,0x00,0x30,0x7D,0x30,0x00,	// 0xAD
+0x00,0x08,0x14,0x00,0x08,0x14,	// 0xAE
+0x00,0x14,0x08,0x00,0x14,0x08,	// 0xAF
+0x44,0x11,0x44,0x11,0x44,0x11,	// 0xB0
+0xAA,0x55,0xAA,0x55,0xAA,0x55,	// 0xB1
+0xBB,0xEE,0xBB,0xEE,0xBB,0xEE,	// 0xB2
+0x00,0x00,0x00,0xFF,0x00,0x00,	// 0xB3
+0x08,0x08,0x08,0xFF,0x00,0x00,	// 0xB4
+0x00,0x70,0x28,0x25,0x29,0x70,	// 0xB5
+0x00,0x70,0x29,0x25,0x29,0x70,	// 0xB6
+0x00,0x70,0x29,0x25,0x28,0x70,	// 0xB7
+0x3E,0x41,0x5D,0x55,0x41,0x3E,	// 0xB8
+0x0A,0xFB,0x00,0xFF,0x00,0x00,	// 0xB9
+0x00,0xFF,0x00,0xFF,0x00,0x00,	// 0xBA
+0x0A,0xFA,0x02,0xFE,0x00,0x00,	// 0xBB
+0x0A,0x0B,0x08,0x0F,0x00,0x00,	// 0xBC
+0x00,0x18,0x24,0x66,0x24,0x00,	// 0xBD
+0x00,0x29,0x2A,0x7C,0x2A,0x29,	// 0xBE
+0x08,0x08,0x08,0xF8,0x00,0x00,	// 0xBF
+0x00,0x00,0x00,0x0F,0x08,0x08,	// 0xC0
+0x08,0x08,0x08,0x0F,0x08,0x08,	// 0xC1
+0x08,0x08,0x08,0xF8,0x08,0x08,	// 0xC2
+0x00,0x00,0x00,0xFF,0x08,0x08,	// 0xC3
+0x08,0x08,0x08,0x08,0x08,0x08,	// 0xC4
+0x08,0x08,0x08,0xFF,0x08,0x08,	// 0xC5
+0x00,0x20,0x56,0x55,0x56,0x79,	// 0xC6
+0x00,0x70,0x2A,0x25,0x2A,0x71,	// 0xC7
+0x00,0x0F,0x08,0x0B,0x0A,0x0A,	// 0xC8
+0x00,0xFE,0x02,0xFA,0x0A,0x0A,	// 0xC9
+0x0A,0x0B,0x08,0x0B,0x0A,0x0A,	// 0xCA
+0x0A,0xFA,0x02,0xFA,0x0A,0x0A,	// 0xCB
+0x00,0xFF,0x00,0xFB,0x0A,0x0A,	// 0xCC
+0x0A,0x0A,0x0A,0x0A,0x0A,0x0A,	// 0xCD
+0x0A,0xFB,0x00,0xFB,0x0A,0x0A,	// 0xCE
+0x00,0x5D,0x22,0x22,0x22,0x5D,	// 0xCF
+0x00,0x22,0x55,0x59,0x30,0x00,	// 0xD0
+0x00,0x08,0x7F,0x49,0x41,0x3E,	// 0xD1
+0x00,0x7C,0x55,0x55,0x55,0x44,	// 0xD2
+0x00,0x7C,0x55,0x54,0x55,0x44,	// 0xD3
+0x00,0x7C,0x55,0x55,0x54,0x44,	// 0xD4
+0x00,0x00,0x00,0x07,0x00,0x00,	// 0xD5
+0x00,0x00,0x44,0x7D,0x45,0x00,	// 0xD6
+0x00,0x00,0x45,0x7D,0x45,0x00,	// 0xD7
+0x00,0x00,0x45,0x7C,0x45,0x00,	// 0xD8
+0x08,0x08,0x08,0x0F,0x00,0x00,	// 0xD9
+0x00,0x00,0x00,0xF8,0x08,0x08,	// 0xDA
+0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,	// 0xDB
+0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,	// 0xDC
+0x00,0x00,0x00,0x77,0x00,0x00,	// 0xDD
+0x00,0x00,0x45,0x7D,0x44,0x00,	// 0xDE
+0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,	// 0xDF
+0x00,0x3C,0x42,0x43,0x3D,0x00,	// 0xE0
+0x00,0xFE,0x4A,0x4A,0x34,0x00,	// 0xE1
+0x00,0x3C,0x43,0x43,0x3D,0x00,	// 0xE2
+0x00,0x3D,0x43,0x42,0x3C,0x00,	// 0xE3
+0x00,0x32,0x49,0x4A,0x31,0x00,	// 0xE4
+0x00,0x3A,0x45,0x46,0x39,0x00,	// 0xE5
+0x00,0xFC,0x20,0x20,0x1C,0x00,	// 0xE6
+0x00,0xFE,0xAA,0x28,0x10,0x00,	// 0xE7
+0x00,0xFF,0xA5,0x24,0x18,0x00,	// 0xE8
+0x00,0x3C,0x40,0x41,0x3D,0x00,	// 0xE9
+0x00,0x3C,0x41,0x41,0x3D,0x00,	// 0xEA
+0x00,0x3D,0x41,0x40,0x3C,0x00,	// 0xEB
+0x00,0x9C,0xA0,0x61,0x3D,0x00,	// 0xEC
+0x00,0x04,0x08,0x71,0x09,0x04,	// 0xED
+0x00,0x00,0x02,0x02,0x02,0x00,	// 0xEE
+0x00,0x00,0x07,0x03,0x00,0x00,	// 0xEF
+0x00,0x00,0x08,0x08,0x08,0x00,	// 0xF0
+0x00,0x00,0x24,0x2E,0x24,0x00,	// 0xF1
+0x00,0x24,0x24,0x24,0x24,0x24,	// 0xF2
+0x05,0x17,0x0A,0x34,0x2A,0x78,	// 0xF3
+0x00,0x06,0x09,0x7F,0x01,0x7F,	// 0xF4
+0x00,0x22,0x4D,0x55,0x59,0x22,	// 0xF5
+0x00,0x08,0x08,0x2A,0x08,0x08,	// 0xF6
+0x00,0x00,0x08,0x18,0x18,0x00,	// 0xF7
+0x00,0x06,0x09,0x09,0x06,0x00,	// 0xF8
+0x00,0x00,0x08,0x00,0x08,0x00,	// 0xF9
+0x00,0x00,0x08,0x00,0x00,0x00,	// 0xFA
+0x00,0x02,0x0F,0x00,0x00,0x00,	// 0xFB
+0x00,0x09,0x0F,0x05,0x00,0x00,	// 0xFC
+0x00,0x09,0x0D,0x0A,0x00,0x00,	// 0xFD
+0x00,0x3C,0x3C,0x3C,0x3C,0x00,	// 0xFE
+0x00,0x00,0x00,0x00,0x00,0x00 	// 0xFF
+};
+
+  ////////////////////////
+ //    Misc functions  //
+////////////////////////
+//Read and clear encoder steps
+int get_tuning_steps(void)
+{
+	int steps;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		steps = enc_count;
+		enc_count = 0;
+		enc_hz = 0;
+		enc_grid = 1;
+		events &= ~EV_ENC; //Consumed by menu or settings screen
+		tlat_pending = 0;  //Not a tuning step
+	}
+	
+	return steps;
+}		
+
+//Read and clear accelerated tuning in Hz (CW < 0 < CCW),
+//grid gets the largest step size used
+long get_tuning_hz(unsigned int *grid)
+{
+	long hz;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		hz = enc_hz;
+		*grid = enc_grid;
+		enc_hz = 0;
+		enc_grid = 1;
+		enc_count = 0;
+		
+		//Measure until DDS1 gets the new frequency, steps back and forth to zero don't count
+		if(tlat_pending && hz)
+		{
+			tlat_t0 = tlat_stamp;
+			tlat_armed = 1;
+		}
+		tlat_pending = 0;
+	}
+	
+	return hz;
+}	
+
+//Clock in 64us ticks, wraps after 4.2s
+unsigned int get_fine_ticks(void)
+{
+	return get_clock_ticks() >> 4;
+}	
+
+//Tuning step in Hz for step period on selected curve
+unsigned int accel_step_hz(unsigned int period)
+{
+	int t1;
+	unsigned int hz = accel_curve[tune_accel][0][1];
+	
+	for(t1 = 1; t1 < ACCEL_LEN; t1++)
+	{
+		if(period < accel_curve[tune_accel][t1][0])
+		{
+			hz = accel_curve[tune_accel][t1][1];
+		}
+	}
+	
+	return hz;
+}		
+
+//Move position in list 0..maxpos by steps, wraps around (CW counts up)
+int wrap_step(int pos, int steps, int maxpos)
+{
+	pos = (pos - steps) % (maxpos + 1);
+	if(pos < 0)
+	{
+		pos += maxpos + 1;
+	}
+	return pos;
+}	
+
+//Move value by steps * stepsize, limited to vmin..vmax (CW counts up)
+int limit_step(int val, int steps, int stepsize, int vmin, int vmax)
+{
+	long v = val - (long) steps * stepsize;
+	
+	if(v < vmin)
+	{
+		return vmin;
+	}
+	if(v > vmax)
+	{
+		return vmax;
+	}
+	return v;
+}		
+
+  ////////////////////////
+ //    SPI for DDS 1   //
+////////////////////////
+void spi1_send_bit(int sbit)
+{
+    hal_port_clr(DDS1_PORT, DDS1_SCLK);  //SCLK lo
+    	
+    if(sbit)
+	{
+		hal_port_set(DDS1_PORT, DDS1_SDIO);  //SDATA  set
+	}
+	else
+	{
+		hal_port_clr(DDS1_PORT, DDS1_SDIO);  //SDATA  erase
+	}
+	
+    hal_port_set(DDS1_PORT, DDS1_SCLK); //SCLK hi
+	
+}
+
+void spi1_send_byte(unsigned int sbyte)
+{
+    int t1, x = (1 << 7);
+	
+	for(t1 = 0; t1 < 8; t1++)
+	{
+	    spi1_send_bit(sbyte & x);	
+		x >>= 1;
+	}	
+}
+
+void spi1_send_word(unsigned int sword)
+{
+    int t1, x = (1 << 15);
+	
+	for(t1 = 0; t1 < 16; t1++)
+	{
+	    spi1_send_bit(sword & x);	
+		x >>= 1;
+	}	
+}
+
+//Frequency tuning word AD9951 DDS for dial frequency
+//f.clock = 400MHz
+unsigned long calc_ftw1(unsigned long f, int sb)
+{
+	if(!sb)//Calculate correct offset from center frequency in display for each sideband
+	{
+	     f += INTERFREQUENCY + 1300; //USB
+	}    
+	else
+    {
+	     f += INTERFREQUENCY - 1300; //LSB
+	}    
+	
+	return ((unsigned long long) f * DDS1_FTW_K) >> 24;
+}	
+
+//SET frequency AD9951 DDS
+void set_frequency1(long frequency)
+{
+	PROF_BEGIN;
+	
+	dds_busy = 1;
+	dds1_send_ftw(calc_ftw1(frequency, sideband));
+	if(tlat_armed)
+	{
+		tlat_record();
+	}	
+	dds_busy = 0;
+	dds_catch_up();
+	
+	PROF_END(PROF_SET_FREQUENCY1);
+}	
+
+//Set current VFO to f (0 keeps it), tune it by df Hz (CW < 0 < CCW) on grid and send it to DDS1.
+//dds_busy is set before cur_vfo and f_vfo are read, a PTT edge from then on is caught up afterwards.
+void set_vfo_frequency(unsigned long f, long df, unsigned int grid)
+{
+	int vfo;
+	PROF_BEGIN;
+	
+	dds_busy = 1;
+	vfo = cur_vfo;
+	if(!f)
+	{
+		f = f_vfo[vfo];
+	}
+	if(df)
+	{
+		f -= df;
+		if(grid >= 10)
+		{
+			f -= f % grid;
+		}
+	}
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) //Read by dds_catch_up()
+	{
+	    f_vfo[vfo] = f;
+	}    	
+	dds1_send_ftw(calc_ftw1(f, sideband));
+	if(tlat_armed)
+	{
+		tlat_record();
+	}	
+	dds_busy = 0;
+	dds_catch_up();
+	
+	PROF_END(PROF_SET_FREQUENCY1);
+}	
+
+//Transfer tuning word to AD9951 DDS
+void dds1_send_ftw(unsigned long fword)
+{
+    int t1, t2, shiftbyte = 24, resultbyte, x;
+    unsigned long comparebyte = 0xFF000000;
+	
+    //Start transfer to DDS
+    hal_port_clr(DDS1_PORT, DDS1_IO_UD); //DDS1_IO_UD lo
+    
+	//Send instruction bit to set fequency by frequency tuning word
+	x = (1 << 7);
+	for(t1 = 0; t1 < 8; t1++)
+	{
+	    spi1_send_bit(0x04 & x);	
+		x >>= 1;
+	}	
+	
+    //Calculate and transfer the 4 bytes of the tuning word to DDS
+    //Start with msb
+    for(t1 = 0; t1 < 4; t1++)
+    {
+        resultbyte = (fword & comparebyte) >> shiftbyte;
+        comparebyte >>= 8;
+        shiftbyte -= 8;       
+        x = (1 << 7);
+        for(t2 = 0; t2 < 8; t2++)
+	    {
+	        spi1_send_bit(resultbyte & x);	
+		    x >>= 1;
+	    }	
+    }    
+	
+	//End transfer sequence
+    hal_port_set(DDS1_PORT, DDS1_IO_UD); //DDS1_IO_UD hi 
+}
+
+  /////////////////
+ //  SPI DDS2   //
+/////////////////
+void spi2_start(void)
+{
+	hal_port_set(DDS2_PORT, DDS_SCLK);      //SCLK hi
+    hal_port_clr(DDS2_PORT, DDS_FSYNC);  //FSYNC lo
+}
+
+void spi2_stop(void)
+{
+	hal_port_set(DDS2_PORT, DDS_FSYNC); //FSYNC hi
+}
+
+void spi2_send_bit(int sbit)
+{
+    if(sbit)
+	{
+		hal_port_set(DDS2_PORT, DDS_SDATA);  //SDATA hi
+	}
+	else
+	{
+		hal_port_clr(DDS2_PORT, DDS_SDATA);  //SDATA lo
+	}
+	
+	hal_port_set(DDS2_PORT, DDS_SCLK);     //SCLK hi
+    
+    hal_port_clr(DDS2_PORT, DDS_SCLK);  //SCLK lo
+}
+
+//Frequency tuning word AD9834 DDS
+//f.clock = 75MHz
+unsigned long calc_ftw2(unsigned long f)
+{
+	return ((unsigned long long) f * DDS2_FTW_K) >> 28;
+}	
+
+//SET frequency AD9834 DDS
+void set_frequency2(unsigned long f)
+{
+	PROF_BEGIN;
+	
+	dds_busy = 1;
+	dds2_send_ftw(calc_ftw2(f));
+	dds_busy = 0;
+	dds_catch_up();
+	
+	PROF_END(PROF_SET_FREQUENCY2);
+}	
+
+//Transfer tuning word to AD9834 DDS
+void dds2_send_ftw(unsigned long fword1)
+{
+    long x;
+    int l[] = {0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    int m[] = {0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, t1;
+
+    //Transfer frequency word to byte array
+    x = (1 << 13);      //2^13
+    for(t1 = 2; t1 < 16; t1++)
+    {
+		if(fword1 & x)
+	    {
+			l[t1] = 1;
+	    }
+	    x >>= 1;
+    }
+    
+    x = (1L << 27);  //2^27
+    for(t1 = 2; t1 < 16; t1++)
+    {
+	    if(fword1 & x)
+	    {
+	        m[t1] = 1;
+	    }
+	    x >>= 1;
+    }
+    ////////////////////////////////////////
+    
+    //Transfer to DDS
+    //Send start command
+    spi2_start();
+    for(t1 = 15; t1 >= 0; t1--)
+    {
+       spi2_send_bit(0x2000 & (1 << t1));
+    }
+    spi2_stop();
+        
+    //Transfer frequency word	
+    //L-WORD
+    spi2_start();
+    for(t1 = 0; t1 < 16; t1++)
+    {
+       spi2_send_bit(l[t1]);
+    }
+    spi2_stop();
+	
+	//M-WORD
+	spi2_start();
+    for(t1 = 0; t1 < 16; t1++)
+    {
+       spi2_send_bit(m[t1]);
+    }
+    spi2_stop();
+}
+
+//Send current VFO and LO if the fast path could not while a transfer was running
+void dds_catch_up(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if(dds_redo)
+		{
+			dds_redo = 0;
+			dds_peek = 0;
+			dds1_send_ftw(calc_ftw1(f_vfo[cur_vfo], sideband));
+			dds2_send_ftw(calc_ftw2(f_lo[sideband]));
+		}
+	}
+}	
+
+  /////////////////////////////
+ //  PTT and sideband switch //
+/////////////////////////////
+//Initial state of switches
+void pin_init(void)
+{
+	pin_state = hal_port_in(PIND) & PIN_MASK;
+	txrx = (pin_state & (1 << PD0)) ? 1 : 0;
+	sideband = (pin_state & (1 << PD1)) ? 0 : 1;
+	
+	//Pin change interrupts for PTT (PD0) and sideband switch (PD1)
+	hal_pcint_init(PIN_MASK);
+}	
+
+//Take changed pins that are out of debounce time, interrupt context
+void pin_update(void)
+{
+	unsigned char pins = hal_port_in(PIND) & PIN_MASK;
+	unsigned char changed = 0;
+	int t1;
+	
+	for(t1 = 0; t1 < 2; t1++)
+	{
+		if(((pins ^ pin_state) & (1 << t1)) && clock_ms - pin_time[t1] >= PIN_DEBOUNCE)
+		{
+			pin_state ^= (1 << t1);
+			pin_time[t1] = clock_ms;
+			changed |= (1 << t1);
+		}
+	}
+	
+	if(changed)
+	{
+		pin_fast_path(changed);
+		post_event(EV_PIN); //Display is done by tasks
+	}
+}	
+
+//Switch split VFO and sideband LO before the display is touched, interrupt context
+void pin_fast_path(unsigned char changed)
+{
+	if(changed & (1 << PD0))
+	{
+		txrx = (pin_state & (1 << PD0)) ? 1 : 0;
+		if(split)
+		{
+			cur_vfo = txrx ? vfo_y : vfo_x;
+		}	
+	}
+	
+	if(changed & (1 << PD1))
+	{
+		sideband = (pin_state & (1 << PD1)) ? 0 : 1;
+	}
+	
+	if(dds_busy) //Main is in the middle of a transfer
+	{
+		dds_redo = 1;
+		return;
+	}
+	
+	//PTT during a dual watch peek: back home before transmitting
+	if((changed & (1 << PD1)) || split || ((changed & (1 << PD0)) && dds_peek))	
+	{
+		dds_peek = 0;
+		dds1_send_ftw(calc_ftw1(f_vfo[cur_vfo], sideband));
+	}
+	if(changed & (1 << PD1))
+	{
+		dds2_send_ftw(calc_ftw2(f_lo[sideband]));
+	}	
+}		
+
+void set_lo_freq(int sb)
+{
+	lcd_cls(0, 83, 0, 47);
+		
+	lcd_putstring(18, 0, " LO FREQ ", 0, 1);
+	if(!sb)
+	{
+		lcd_putstring(18, 2, "USB", 0, 0);
+	}
+	else	
+	{
+		lcd_putstring(18, 2, "LSB", 0, 0);
+	}
+		
+	scr_arg = sb;
+	scr_val = f_lo[sb];
+	show_frequency2(scr_val);
+	screen_open(SCR_LO);
+}	
+
+//LO screen, key 2 confirms, key 4 steps 100 Hz (repeats while held), other keys abort
+int lo_freq_step(int key, int steps)
+{
+	int sb = scr_arg;
+	
+	if(steps) //CW < 0 < CCW
+	{
+		scr_val -= 10L * steps;
+	    show_frequency2(scr_val);
+	    set_frequency2(scr_val);
+	}
+	
+	if(!key)
+	{
+		return 0;
+	}
+	
+	if(key == 2)
+	{
+		f_lo[sb] = scr_val; //Confirm
+		store_frequency(scr_val, 35 + sb);
+	}	
+	else
+	{
+		set_frequency2(f_lo[sb]); //Abort and restore old data
+	}	
+	
+	return 1;
+}	
+
+  //////////////////////
+ //    SPI for LCD   //
+//////////////////////
+//Send the information to LCD (command or data)
+void lcd_sendbyte(char x, int command)
+{ 
+    int t1, bx = 128;
+	PROF_BEGIN;
+	
+	if(command)
+	{   //CMD
+	    hal_port_clr(LCD_PORT, DC);
+	}
+	else 
+    {  //DATA
+	    hal_port_set(LCD_PORT, DC);
+	} 
+	
+    for(t1 = 0; t1 < 8; t1++)
+    { 
+	    hal_port_clr(LCD_PORT, LCDSCLK);
+			    
+        if(x & bx)
+	    {
+            hal_port_set(LCD_PORT, DN); 
+		}
+	    else
+        {
+	        hal_port_clr(LCD_PORT, DN);
+	    }	
+        
+		hal_port_set(LCD_PORT, LCDSCLK);
+    	
+		bx >>= 1;
+    }
+    
+    PROF_END(PROF_LCD_SENDBYTE);
+}
+
+//Send display data to Nokia LCD 5110
+void lcd_senddata(char x)
+{
+    lcd_sendbyte(x, 0);
+}
+
+//Send  command to Nokia LCD 5110
+void lcd_sendcmd(char x)
+{
+    lcd_sendbyte(x, 1);
+}
+
+//Reset LCD when program starts
+void lcd_reset(void)
+{
+    hal_port_clr(LCD_PORT, RES);
+	_delay_us(100);
+    hal_port_set(LCD_PORT, RES);
+}	
+
+//Init NOKIA 5110 LCD
+void lcd_init(void)
+{
+
+    _delay_ms(20);
+	lcd_reset();
+		
+	//Configure the display
+    lcd_sendcmd(0x21);    //Extended commands follow
+    lcd_sendcmd(0xBF);    //Set Vop (Contrast)
+    lcd_sendcmd(0x04);    //Set Temp. coefficient
+    lcd_sendcmd(0x14);    //LCD bias mode
+    lcd_sendcmd(0x20);    //Normal instruction set
+    lcd_sendcmd(0x0C);    //Set display to normal mode.
+	
+	lcd_cleanram();
+    _delay_ms(100);
+}	
+
+//Clear part of LCD
+void lcd_clearsection(int x0, int x1, int y0)
+{
+    int t1;
+	
+	for(t1 = x0; t1 < x1; t1++)
+	{
+	    lcd_gotoxy(t1, y0);
+		lcd_senddata(0x00);
+	}	
+
+}
+
+//Clear whole LCD
+void lcd_cls(int x0, int x1, int y0, int y1)
+{
+    int x, y;
+	
+	for(y = y0; y < y1; y++)
+	{
+	    for(x = x0; x < x1; x++)
+		{
+            lcd_gotoxy(x, y);
+		    lcd_senddata(0x00);
+		}
+	}	
+}
+
+//Set pos of cursor to start next text display on LCD
+void lcd_gotoxy(char x, char y)
+{ 
+    lcd_sendcmd(0x40 | (y & 0x07));
+    lcd_sendcmd(0x80 | (x & 0x7F));
+}
+
+//Init RAM of LCD
+void lcd_cleanram(void)
+{
+    int i;
+    
+	lcd_gotoxy(0,0);
+	
+    _delay_ms(10);
+    
+	for(i = 0; i < 768; i++)
+    {
+        lcd_senddata(0x00);
+	}	
+    
+	_delay_ms(1);
+}
+
+//Power of 2
+int xp2(int xp)
+{
+    int t1, r = 1;
+    for(t1 = 0; t1 < xp; t1++)
+    {
+	    r <<= 1;
+    }
+    return r;
+
+}
+
+//Print character in normal size
+void lcd_putchar1(int col, int row, char ch1, int inv)
+{ 
+    int p, t1;
+    char ch2;
+	
+	lcd_gotoxy(col, row);
+    
+    p = (FONTWIDTH * ch1); // - 32 * FONTWIDTH;
+    for(t1 = FONTWIDTH; t1 > 0; t1--)
+    { 
+	    if(!inv)
+		{
+	        ch2 = xchar[p];
+		}
+		else
+		{
+	        ch2 = ~xchar[p];
+		}
+		
+        lcd_senddata(ch2);
+        p++;
+    }
+	
+	if(!inv)
+	{
+	    lcd_senddata(0x00);
+	}
+	else
+	{
+	    lcd_senddata(0xFF);
+	}
+}
+
+//Print character in double size
+void lcd_putchar2(int col, int row, char ch1, int inv)
+{ 
+    int p, t1, t2, x;
+	int b, b1, b2; 
+    char colval;
+    PROF_BEGIN;
+	   
+    p = (FONTWIDTH * ch1);// - FONTWIDTH * 32;
+    	
+	for(t2 = 0; t2 < FONTWIDTH; t2++)
+    { 
+	    //Get vertical byte data of char
+		if(!inv)
+		{
+	        colval = xchar[p];
+		}
+		else
+		{
+	        colval = ~xchar[p];
+		}
+	  		
+		b = 0;
+		x = 1;
+        
+		for(t1 = 0; t1 < 7; t1++)
+        {
+            if(colval & x)
+            {
+	            b += xp2(t1 * 2);
+	            b += xp2(t1 * 2 + 1);
+            }
+            x <<= 1;
+	    }
+    
+        b1 = b & 0xFF; //Lower byte
+        b2 = (b & 0xFF00) >> 8; //Upper byte
+		
+		//Print data to screen
+		lcd_gotoxy(col + t2 * 2, row);
+		lcd_senddata(b1);
+		lcd_gotoxy(col + t2 * 2, row + 1);
+		lcd_senddata(b2);
+		lcd_gotoxy(col + t2 * 2 + 1, row);
+		lcd_senddata(b1);
+		lcd_gotoxy(col + t2 * 2 + 1, row + 1);
+		lcd_senddata(b2);
+		p++;
+	}	
+    
+    lcd_senddata(0x00);
+    
+    PROF_END(PROF_LCD_PUTCHAR2);
+}
+
+//Print string in certain size
+void lcd_putstring(int col, int row, char *s, char lsize, int inv)
+{
+    int c = col;
+	
+	while(*s)
+	{
+	    if(!lsize)
+		{
+	        lcd_putchar1(c, row, *s++, inv);
+		}
+        else
+        {
+            lcd_putchar2(c, row, *s++, inv);
+		}	
+		c += (lsize + 1) * FONTWIDTH;
+	}
+}
+
+//Print a number
+void lcd_putnumber(int col, int row, long num, int dec, int lsize, int inv)
+{
+    char *s = malloc(16);
+	if(s != NULL)
+	{
+	    int2asc(num, dec, s, 16);
+	    lcd_putstring(col, row, s, lsize, inv);
+	    free(s);
+	}	
+}
+
+void lcd_drawbox(int x0, int y0, int x1, int y1)
+{
+	int t1;
+	
+	for(t1 = x0 + FONTWIDTH; t1 < x1; t1 += FONTWIDTH)
+	{
+		lcd_putchar1(t1, y0, 0xC4, 0);
+		lcd_putchar1(t1, y1, 0xC4, 0);
+	}
+	
+	for(t1 = y0 + 1; t1 < y1; t1++)
+	{
+		lcd_putchar1(x0, t1, 0xB3, 0);
+		lcd_putchar1(x1, t1, 0xB3, 0);
+	}
+	
+	lcd_putchar1(x0, y0, 0xDA, 0); //Left top corner
+	lcd_putchar1(x1, y0, 0xBF, 0); //Right top corner
+	lcd_putchar1(x0, y1, 0xC0, 0); //Left bottom corner
+	lcd_putchar1(x1, y1, 0xD9, 0); //Right bottom corner
+}
+		
+
+  //////////////////////
+ // STRING FUNCTIONS //
+//////////////////////
+//INT 2 ASC
+int int2asc(long num, int dec, char *buf, int buflen)
+{
+    int i, c, xp = 0, neg = 0;
+    long n, dd = 1E09;
+    PROF_BEGIN;
+
+    if(!num)
+	{
+	    *buf++ = '0';
+		*buf = 0;
+		PROF_END(PROF_INT2ASC);
+		return 1;
+	}	
+		
+    if(num < 0)
+    {
+     	neg = 1;
+	    n = num * -1;
+    }
+    else
+    {
+	    n = num;
+    }
+
+    //Fill buffer with \0
+    for(i = 0; i < 12; i++)
+    {
+	    *(buf + i) = 0;
+    }
+
+    c = 9; //Max. number of displayable digits
+    while(dd)
+    {
+	    i = n / dd;
+	    n = n - i * dd;
+	
+	    *(buf + 9 - c + xp) = i + 48;
+	    dd /= 10;
+	    if(c == dec && dec)
+	    {
+	        *(buf + 9 - c + ++xp) = '.';
+	    }
+	    c--;
+    }
+
+    //Search for 1st char different from '0'
+    i = 0;
+    while(*(buf + i) == 48)
+    {
+	    *(buf + i++) = 32;
+    }
+
+    //Add minus-sign if neccessary
+    if(neg)
+    {
+	    *(buf + --i) = '-';
+    }
+
+    //Eleminate leading spaces
+    c = 0;
+    while(*(buf + i))
+    {
+	    *(buf + c++) = *(buf + i++);
+    }
+    *(buf + c) = 0;
+	
+	PROF_END(PROF_INT2ASC);
+	return c;
+}
+
+//STRLEN
+int strlen(char *s)
+{
+   int t1 = 0;
+
+   while(*(s + t1++));
+
+   return (t1 - 1);
+}
+
+ ////////////////////////////////////////////
+ //     RADIO DATA DISPLAY ROUTINES        // 
+////////////////////////////////////////////
+//Current frequency (double letter height)
+void show_frequency(unsigned long f)
+{
+	if(f == 0)
+	{
+	    lcd_putstring(0, 2, "       ", 1, 0);
+	}
+	else
+	{
+		lcd_putnumber(0, 2, f / 100, 1, 1, 0);
+	}	    
+	    
+}
+
+//Memeory frequency on selection memplace in menu
+void show_frequency2(unsigned long f)
+{
+	if(!f)
+	{
+		lcd_putstring(12, 4, "-------", 0, 0);
+	}
+	else
+	{	
+        lcd_putstring(12, 4, "       ", 0, 0);
+	    lcd_putnumber(12, 4, f / 100, 1, 0, 0);
+	}    
+}	
+
+void show_sideband(int sb, int invert)
+{
+	int xpos = 0, ypos = 0, xlen = 3;
+    char *sb_str[] = {"USB", "LSB"};
+		
+	//Clear section of LCD
+	lcd_clearsection(xpos * FONTWIDTH, xpos + xlen * 6, ypos);
+	
+	//Write string to position
+	lcd_putstring(xpos * FONTWIDTH, ypos, sb_str[sb], 0, invert);
+}
+
+//Inverted if below alarm threshold
+void show_voltage(int v1)
+{
+    char *buf;
+	int t1, p;
+	int xpos = 9, ypos = 0, xlen = 5;
+	int inv = (v1 < volt_alarm);
+	
+	lcd_clearsection(xpos * FONTWIDTH, (xpos + xlen) * FONTWIDTH, ypos);
+	
+	buf = malloc(10);
+	//Init buffer string
+	for(t1 = 0; t1 < 10; t1++)
+	{
+	    *(buf + t1) = 0;
+	}
+    p = int2asc(v1, 1, buf, 6) * FONTWIDTH;
+    lcd_putstring(xpos * FONTWIDTH, ypos, buf, 0, inv);
+	lcd_putchar1(xpos * FONTWIDTH + p, ypos, 'V', inv);
+	free(buf);
+}
+
+//S-Meter bargraph (Page 6)
+void show_meter(int sv0)
+{
+    int t1;
+    
+    int sv = sv0 + (sv0 >> 1);
+    PROF_BEGIN;
+	
+    if(sv > 83)
+	{
+	    sv = 83;
+	}
+	
+	//Clear bar graph
+	for(t1 = 0; t1 < smax - 2; t1 += 2)
+	{
+	    lcd_gotoxy(t1, 4);
+		lcd_senddata(0x00);
+	}	
+    
+	//Draw new bar graph
+	for(t1 = 0; t1 < sv; t1 += 2)
+	{
+	    lcd_gotoxy(t1, 4);
+		lcd_senddata(0x7E);
+	}	
+	
+	if(sv > smax)
+	{
+		smax = sv;
+		time_smax = get_clock_ms();
+	}	
+	
+	PROF_END(PROF_SHOW_METER);
+}
+
+//Reset max value of s meter
+void reset_smax(void)
+{
+	int t1;
+	
+	//Clear bar graph
+	for(t1 = 0; t1 < smax; t1 += 2)
+	{
+	    lcd_gotoxy(t1, 4);
+		lcd_senddata(0x00);
+	}	
+	
+	time_smax = get_clock_ms();
+	smax = 0;	
+}	
+
+void show_mem_addr(int mem_addr, int invert)
+{
+	int xpos = 0, ypos = 1, xlen = 3;
+    unsigned long mem_freq;
+    		
+	//Clear section of LCD
+	lcd_clearsection(xpos * FONTWIDTH, xpos + xlen * 6, ypos);
+	
+	//Show number of mem place
+	lcd_putstring(xpos * FONTWIDTH, ypos, "M", 0, invert);
+	if(mem_addr < 10)
+	{
+	     lcd_putnumber((xpos + 1) * FONTWIDTH, ypos, 0, -1, 0, invert);				
+	     lcd_putnumber((xpos + 2) * FONTWIDTH, ypos, mem_addr, -1, 0, invert);				
+	}
+	else
+	{
+	     lcd_putnumber((xpos + 1) * FONTWIDTH, ypos, mem_addr, -1, 0, invert);				
+	}
+	
+	//Show respective frequency
+	mem_freq = load_mem_freq(mem_addr);
+	if(is_mem_freq_ok(mem_freq))
+	{
+	    show_mem_freq(mem_freq, invert);
+	}
+	else    
+	{
+	    show_mem_freq(0, invert);
+	}   
+}
+
+void show_mem_freq(unsigned long f, int invert)
+{
+	
+	int xpos = 4, ypos = 1, xlen = 8;
+    		
+	//Clear section of LCD
+	lcd_clearsection(xpos * FONTWIDTH, xpos + xlen * 6, ypos);
+	
+	if(f)
+	{
+	    lcd_putnumber(xpos * FONTWIDTH, ypos, f / 100, 1, 0, invert);			
+	}   
+	else
+	{
+	    lcd_putstring(xpos * FONTWIDTH, ypos, " ----- ", 0, invert);			
+	}    
+}	
+
+void show_pa_temp(int patemp)
+{
+    char *buf;
+    int t1, p;
+	int xpos = 4, ypos = 0, xlen = 5;
+	
+	lcd_clearsection(xpos * FONTWIDTH, (xpos + xlen) * 6, ypos);
+		
+	buf = malloc(10);
+	//Init buffer string
+	for(t1 = 0; t1 < 10; t1++)
+	{
+	    *(buf + t1) = 0;
+	}
+    p = int2asc(patemp / 10, -1, buf, 6);
+    lcd_putstring(xpos * FONTWIDTH, ypos, buf, 0, 0);
+    lcd_putchar1((xpos + p) * FONTWIDTH, ypos, 0xF8, 0); //Symbol #248
+	lcd_putstring((xpos + p + 1) * FONTWIDTH, ypos, "C", 0, 0);
+	free(buf);
+}
+
+void show_all_data(unsigned long f,  int sb, int v, int mem, int vfo, int spl)
+{
+	unsigned long f2;
+	
+	lcd_cls(0, 84, 0, 48);
+	
+    show_frequency(f);
+    show_sideband(sb, 0);
+    show_meter_scale(hal_port_in(PIND) & (1 << PD0));
+    show_voltage(v);
+    show_pa_temp(get_temp());    				
+    show_mem_addr(mem, 0);
+	f2 = load_mem_freq(mem);
+	if(is_mem_freq_ok(f2))
+	{
+		show_mem_freq(f2, 0);
+	}
+	else
+	{
+		show_mem_freq(0, 0);
+	}
+	show_vfo(vfo, spl);
+		
+}
+
+void show_vfo(int n_vfo, int split)
+{
+	int xpos = 12, ypos = 1;
+	
+	//Write string to position
+	if(!split)
+	{
+	    lcd_putchar1(xpos * FONTWIDTH, ypos, n_vfo + 65, 0);
+	    lcd_putchar1((xpos + 1) * FONTWIDTH, ypos, 32, 0);
+	}   
+	else
+	{
+		if(!n_vfo)
+		{
+	        lcd_putchar1(xpos * FONTWIDTH, ypos, 65, 1);
+	        lcd_putchar1((xpos + 1) * FONTWIDTH, ypos,  66, 0);
+	    }   
+	    else
+	    {
+	        lcd_putchar1(xpos * FONTWIDTH, ypos, 65, 0);
+	        lcd_putchar1((xpos + 1) * FONTWIDTH, ypos, 66, 1);
+	    }   
+	}   
+}	
+
+void show_meter_scale(int scale)
+{
+	int t1;
+	
+	//Define characters for the display line
+    char scalestr[] = {0, 76, 146, 146, 100, 0, 0, 254, 0, 0, 0, 68, 130, 146, 108, 0, 0, 0, 94, 146, 146, 98, 0, 0, 0, 194, 34, 18, 14, 0, 0, 0, 76, 146, 146, 108, 0, 0, 0, 16, 56, 16, 0, 254, 0, 120, 132, 132, 120, 0, 0, 0, 16, 56, 16, 0, 228, 146, 146, 140, 0, 120, 132, 132, 120, 0, 0, 0, 112, 136, 136, 254, 0, 254, 146, 146, 108};
+
+	if(!scale)
+	{
+		lcd_gotoxy(0, 5);
+    
+        for(t1 = 0; t1 < 77; t1++)
+        {
+            lcd_senddata(scalestr[t1]);
+        }   
+	}
+	else
+	{
+		lcd_putstring(0, 5, "2 4 6 8 10W   ", 0, 0);
+	}
+}			
+	
+//////////////////////
+//   E  E  P  R  O  M
+//////////////////////
+void store_frequency(long f, int memplace)
+{
+	PROF_BEGIN;
+	
+	store_frequency_adr(f, memplace * 4);
+	
+	PROF_END(PROF_STORE_FREQUENCY);
+}
+
+unsigned long load_frequency(int memplace)
+{
+	return load_frequency_adr(memplace * 4);
+}
+
+//MSB first. Interrupts stay on (no ISR uses the EEPROM), bytes that
+//did not change are not written.
+void store_frequency_adr(long f, int start_adr)
+{
+    int t1;
+	
+    for(t1 = 0; t1 < 4; t1++)
+    {
+		eeprom_update_byte((uint8_t*)start_adr + t1, (unsigned long) f >> (24 - 8 * t1));
+	}
+}
+
+unsigned long load_frequency_adr(int start_adr)
+{
+    long rf;
+    unsigned char hmsb, lmsb, hlsb, llsb;
+		
+    hmsb = eeprom_read_byte((uint8_t*)start_adr);
+    hlsb = eeprom_read_byte((uint8_t*)start_adr + 1);
+    lmsb = eeprom_read_byte((uint8_t*)start_adr + 2);
+    llsb = eeprom_read_byte((uint8_t*)start_adr + 3);
+	
+    rf = (long) 16777216 * hmsb + (long) 65536 * hlsb + (unsigned int) 256 * lmsb + llsb;
+		
+	return rf;
+	
+}
+
+void store_last_mem(int mem)
+{
+	eeprom_write_byte((uint8_t*)127, mem);
+}
+
+void store_last_vfo(int vfo)
+{
+	eeprom_write_byte((uint8_t*)128, vfo);
+}
+
+int load_last_mem(void)
+{
+	return eeprom_read_byte((uint8_t*)127);
+}
+
+int load_last_vfo(void)
+{
+	return eeprom_read_byte((uint8_t*)128);
+}
+
+void store_vfo_data(int vfo, unsigned long f0, unsigned long f1)
+{
+	store_last_vfo(vfo);
+	store_frequency(f0, 16); //VFO A
+	store_frequency(f1, 17); //VFO B
+}	
+
+  //////////////////////
+ //   MEMORY BANK    //
+//////////////////////
+//Each memory is a packed record of MEMRECSIZE bytes in EEPROM.
+//A memory is empty if its frequency is not in band, flags and
+//label of an empty record are not evaluated.
+unsigned long load_mem_freq(int mem)
+{
+	return load_frequency_adr(MEMBANK_ADR + mem * MEMRECSIZE);
+}
+
+int load_mem_flags(int mem)
+{
+	return eeprom_read_byte((uint8_t*)(MEMBANK_ADR + mem * MEMRECSIZE + 4));
+}
+
+//Label into buffer of MEMLABELLEN + 1 chars, unused EEPROM reads as blanks
+void load_mem_label(int mem, char *buf)
+{
+	int t1;
+	char ch;
+	
+	for(t1 = 0; t1 < MEMLABELLEN; t1++)
+	{
+		ch = eeprom_read_byte((uint8_t*)(MEMBANK_ADR + mem * MEMRECSIZE + 5 + t1));
+		if(ch < 32 || ch > 126)
+		{
+			ch = 32;
+		}
+		buf[t1] = ch;
+	}
+	buf[MEMLABELLEN] = 0;
+}
+
+void store_mem_flags(int mem, int flags)
+{
+	eeprom_update_byte((uint8_t*)(MEMBANK_ADR + mem * MEMRECSIZE + 4), flags);
+	if(flags & MEMFLAG_SKIP)
+	{
+		mem_lock[mem >> 3] |= (1 << (mem & 7));
+	}
+	else
+	{
+		mem_lock[mem >> 3] &= ~(1 << (mem & 7));
+	}	
+}
+
+void store_mem_label(int mem, char *label)
+{
+	int t1;
+	
+	for(t1 = 0; t1 < MEMLABELLEN; t1++)
+	{
+		if(*label)
+		{
+		    eeprom_update_byte((uint8_t*)(MEMBANK_ADR + mem * MEMRECSIZE + 5 + t1), *label++);
+		}
+		else
+		{
+			eeprom_update_byte((uint8_t*)(MEMBANK_ADR + mem * MEMRECSIZE + 5 + t1), 32);
+		}	
+	}
+}
+
+//Write complete record, label == NULL keeps label of an occupied memory
+void store_mem(int mem, unsigned long f, int flags, char *label)
+{
+	int was_ok = is_mem_freq_ok(load_mem_freq(mem));
+	
+	mem_index_remove(mem);
+	store_frequency_adr(f, MEMBANK_ADR + mem * MEMRECSIZE);
+	store_mem_flags(mem, flags);
+	if(label != NULL)
+	{
+		store_mem_label(mem, label);
+	}
+	else
+	{
+		if(!was_ok)
+		{
+			store_mem_label(mem, "");
+		}
+	}		
+	mem_index_insert(mem);
+}
+
+//Copy the 16 memories of the old format into bank once
+void init_mem_bank(void)
+{
+	int t1;
+	unsigned long f;
+	
+	if(eeprom_read_byte((uint8_t*)MEMBANK_MARK_ADR) == MEMBANK_MARK)
+	{
+		return;
+	}
+	
+	for(t1 = 0; t1 < 16; t1++)
+	{
+		f = load_frequency(t1);
+		if(is_mem_freq_ok(f))
+		{
+			store_frequency_adr(f, MEMBANK_ADR + t1 * MEMRECSIZE);
+			store_mem_flags(t1, 0);
+			store_mem_label(t1, "");
+		}
+		else
+		{
+			store_frequency_adr(0, MEMBANK_ADR + t1 * MEMRECSIZE);
+		}	
+	}
+	eeprom_write_byte((uint8_t*)MEMBANK_MARK_ADR, MEMBANK_MARK);
+}
+
+//Remove memory from frequency index
+void mem_index_remove(int mem)
+{
+	int t1, t2;
+	
+	for(t1 = 0; t1 < mem_count; t1++)
+	{
+		if(mem_index[t1] == mem)
+		{
+			for(t2 = t1; t2 < mem_count - 1; t2++)
+			{
+				mem_index[t2] = mem_index[t2 + 1];
+			}
+			mem_count--;
+			return;
+		}
+	}
+}
+
+//Insert memory into frequency index if it holds a valid frequency
+void mem_index_insert(int mem)
+{
+	int t1;
+	unsigned long f = load_mem_freq(mem);
+	
+	if(!is_mem_freq_ok(f))
+	{
+		return;
+	}
+	
+	t1 = mem_count;
+	while(t1 > 0 && load_mem_freq(mem_index[t1 - 1]) > f)
+	{
+		mem_index[t1] = mem_index[t1 - 1];
+		t1--;
+	}
+	mem_index[t1] = mem;
+	mem_count++;
+}
+
+//Index and lockout bitmap of all memories
+void build_mem_index(void)
+{
+	int t1;
+	
+	mem_count = 0;
+	for(t1 = 0; t1 <= MAXMEM; t1++)
+	{
+		mem_index_insert(t1);
+		if(load_mem_flags(t1) & MEMFLAG_SKIP)
+		{
+			mem_lock[t1 >> 3] |= (1 << (t1 & 7));
+		}	
+	}
+}
+
+//Memory is locked out of scan (MEMFLAG_SKIP), without EEPROM access
+int mem_locked(int mem)
+{
+	return mem_lock[mem >> 3] & (1 << (mem & 7));
+}
+
+//Binary search in index, returns memory closest to f or -1 if bank is empty
+int find_nearest_mem(unsigned long f)
+{
+	int lo = 0, hi = mem_count, mid;
+	
+	if(!mem_count)
+	{
+		return -1;
+	}
+		
+	while(lo < hi) //Find 1st entry >= f
+	{
+		mid = (lo + hi) >> 1;
+		if(load_mem_freq(mem_index[mid]) < f)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	
+	if(lo == mem_count)
+	{
+		return mem_index[lo - 1];
+	}
+	
+	if(lo > 0 && f - load_mem_freq(mem_index[lo - 1]) < load_mem_freq(mem_index[lo]) - f)
+	{
+		return mem_index[lo - 1];
+	}
+	
+	return mem_index[lo];
+}
+
+//Label, sideband and skip flag of memory in line 3
+void show_mem_info(int mem)
+{
+	char label[MEMLABELLEN + 1];
+	int flags;
+	
+	lcd_clearsection(0, 84, 3);
+	if(!is_mem_freq_ok(load_mem_freq(mem)))
+	{
+		return;
+	}	
+	
+	flags = load_mem_flags(mem);
+	load_mem_label(mem, label);
+	lcd_putstring(0, 3, label, 0, 0);
+	if(flags & MEMFLAG_LSB)
+	{
+		lcd_putstring(36, 3, "LSB", 0, 0);
+	}
+	else
+	{
+		lcd_putstring(36, 3, "USB", 0, 0);
+	}
+	if(flags & MEMFLAG_SKIP)
+	{
+		lcd_putstring(60, 3, "SKP", 0, 0);
+	}
+}
+
+//Starts at memory nearest to f
+void recall_mem_freq(unsigned long f)
+{
+	int mem_addr = find_nearest_mem(f);
+	
+	if(mem_addr < 0)
+	{
+		mem_addr = 0;
+	}	
+	
+	lcd_cls(0, 83, 0, 47);
+	lcd_putstring(12, 0, "RECALL QRG", 0, 0);
+	
+	//Load initial freq
+	show_mem_addr(mem_addr, 0);
+	show_mem_info(mem_addr);
+	if(is_mem_freq_ok(load_mem_freq(mem_addr)))
+	{
+	    set_frequency1(load_mem_freq(mem_addr));
+		show_frequency(load_mem_freq(mem_addr));
+	}  
+	else  
+	{
+		show_frequency(0);
+	}	
+	
+	scr_pos = mem_addr;
+	screen_open(SCR_RECALL);
+}	
+
+//Recall screen, key 2 tunes current VFO to memory, key 4 toggles skip flag,
+//keys 1 and 3 abort
+int recall_step(int key, int steps)
+{
+	int mem_addr = scr_pos;
+	
+	if(steps)  
+	{    
+	    mem_addr = wrap_step(mem_addr, steps, MAXMEM);
+		scr_pos = mem_addr;
+		
+		show_mem_addr(mem_addr, 0);
+		show_mem_info(mem_addr);
+		if(is_mem_freq_ok(load_mem_freq(mem_addr)))
+		{
+		    set_frequency1(load_mem_freq(mem_addr));
+		    show_frequency(load_mem_freq(mem_addr));
+		}    
+    }
+    
+    switch(key)
+    {
+		case 2: if(is_mem_freq_ok(load_mem_freq(mem_addr)))
+	            {
+	                store_last_mem(mem_addr);
+					set_vfo_frequency(load_mem_freq(mem_addr), 0, 1);
+					last_memplace = load_last_mem();
+	            }    
+	            return 1;
+	            
+	    case 1: 
+	    case 3: return 1;
+	    
+	    case 4: if(is_mem_freq_ok(load_mem_freq(mem_addr))) //Toggle skip flag of this memory
+				{
+					store_mem_flags(mem_addr, load_mem_flags(mem_addr) ^ MEMFLAG_SKIP);
+					show_mem_info(mem_addr);
+				}
+				break;
+	}	
+	
+	return 0;
+}	
+
+//Store f in memory, starts at memory mem
+void save_mem_freq(long f, int mem)
+{
+	lcd_cls(0, 83, 0, 47);
+	lcd_putstring(12, 0, "STORE QRG", 0, 0);
+	
+	//Load initial mem
+	show_mem_addr(mem, 0);
+	show_mem_info(mem);
+	set_frequency1(load_mem_freq(mem));
+	show_frequency(f);
+	
+	scr_pos = mem;
+	scr_val = f;
+	screen_open(SCR_STORE);
+}	
+
+//Store screen, key 2 stores, other keys abort
+int store_step(int key, int steps)
+{
+	int mem_addr = scr_pos;
+	
+	if(steps)  
+	{    
+	    mem_addr = wrap_step(mem_addr, steps, MAXMEM);
+		scr_pos = mem_addr;
+		
+		show_mem_addr(mem_addr, 0);
+		show_mem_info(mem_addr);
+		if(is_mem_freq_ok(load_mem_freq(mem_addr)))
+		{
+		    set_frequency1(load_mem_freq(mem_addr));
+		}    
+    }
+    
+	if(!key)
+	{
+		return 0;
+	}
+	
+	if(key == 2)
+	{
+		if(sideband)
+		{
+		    store_mem(mem_addr, scr_val, MEMFLAG_LSB, NULL);
+		}
+		else
+		{
+		    store_mem(mem_addr, scr_val, 0, NULL);
+		}	
+		store_frequency(f_vfo[cur_vfo], 16 + cur_vfo);
+		last_memplace = mem_addr;
+		store_last_mem(mem_addr);
+		if(mem_addr == prio_mem) //Watch the new frequency from now on
+		{
+			prio_f = scr_val;
+		}
+	}	
+	
+	return 1;
+}	
+
+//Edit label of memory: Knob selects char, key 2 next char (stores after last one),
+//other keys abort
+void edit_mem_label(int mem)
+{
+	if(!is_mem_freq_ok(load_mem_freq(mem)))
+	{
+		return;
+	}
+	
+	load_mem_label(mem, scr_text);
+		
+	lcd_cls(0, 83, 0, 47);
+	lcd_putstring(12, 0, "MEM LABEL", 0, 0);
+	show_mem_addr(mem, 0);
+	
+	scr_arg = mem;
+	scr_pos = 0;
+	mem_label_step(0, 0);
+	screen_open(SCR_LABEL);
+}	
+
+//Label screen, scr_pos is the char being edited
+int mem_label_step(int key, int steps)
+{
+	int setlen = strlen(mem_label_chars);
+	int c = 0, t1;
+	
+	if(key)
+	{
+		if(key != 2)
+		{
+			return 1;
+		}
+		if(++scr_pos >= MEMLABELLEN)
+		{
+			store_mem_label(scr_arg, scr_text);
+			return 1;
+		}
+	}
+	
+	//Position of current char in charset
+	for(t1 = 0; t1 < setlen; t1++)
+	{
+		if(mem_label_chars[t1] == scr_text[scr_pos])
+		{
+			c = t1;
+		}
+	}		
+	c = wrap_step(c, steps, setlen - 1);
+	scr_text[scr_pos] = mem_label_chars[c];
+	
+	for(t1 = 0; t1 < MEMLABELLEN; t1++)
+	{
+	    lcd_putchar2(t1 * 12 + 12, 3, scr_text[t1], t1 == scr_pos);
+	}    
+	
+	return 0;
+}	
+
+  //////////////////////
+ //    A   D   C     //
+/////////////////////
+//Start ADC sequencer, Timer0 in CTC mode serves as conversion trigger
+void adc_init(void)
+{
+	adc_sched_pos = 0;
+	
+	hal_adc_init(ADC_TICK, adc_schedule[0]);
+}	
+
+//Latest ADC value of channel, constant time
+int get_adc(int adc_channel)
+{
+	int adc_val;
+	PROF_BEGIN;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+	    adc_val = adc_slot[adc_channel];
+	}    
+	
+	PROF_END(PROF_GET_ADC);
+	return adc_val;
+}	
+
+//Called from ADC ISR for each sample of a meter channel
+void meter_sample(int m, int val)
+{
+	unsigned int x;
+	
+	meter_acc[m] += val;
+	if(++meter_n[m] < METER_OVERSAMPLE)
+	{
+		return;
+	}
+	
+	x = meter_acc[m];
+	meter_dec[m] = x;
+	if(x > meter_filt[m])
+	{
+		meter_filt[m] += (x - meter_filt[m]) >> METER_ATTACK;
+	}
+	else	
+	{
+		meter_filt[m] -= (meter_filt[m] - x) >> METER_DECAY;
+	}
+	
+	meter_acc[m] = 0;
+	meter_n[m] = 0;
+	meter_seq[m]++;
+}	
+
+//Smoothed meter value (ADC2 or ADC3) in 10 bit ADC scale
+int get_meter(int adc_channel)
+{
+	unsigned int x;
+	
+	if(adc_channel == 2)
+	{
+	    adc_nr_sample();
+	}    
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+	    x = meter_filt[adc_channel - 2];
+	}    
+	
+	return (x + (METER_OVERSAMPLE >> 1)) / METER_OVERSAMPLE;
+}
+
+//Discard the samples of the current block of meter m (0: ADC2, 1: ADC3)
+void meter_restart(int m)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		meter_acc[m] = 0;
+		meter_n[m] = 0;
+	}
+}	
+
+//Discard samples taken so far and wait for next decimated value,
+//used after a DDS step to get a value of the new frequency only
+int get_meter_fresh(int adc_channel)
+{
+	int m = adc_channel - 2;
+	unsigned char seq;
+	unsigned int x;
+	
+	ATOMIC_BLOCK(ATOMIC_FORCEON)
+	{
+		meter_restart(m);
+		seq = meter_seq[m];
+	}
+	
+	while(meter_seq[m] == seq)
+	{
+		if(m == 0)
+		{
+			adc_nr_sample();
+		}
+	}		
+	
+	ATOMIC_BLOCK(ATOMIC_FORCEON)
+	{
+	    x = meter_dec[m];
+	}    
+	
+	return (x + (METER_OVERSAMPLE >> 1)) / METER_OVERSAMPLE;
+}	
+
+//Mean of the next n (1..METER_OVERSAMPLE) samples of ADC2, discards samples taken so far.
+//Shorter than get_meter_fresh() for the dwell of a scan step.
+int get_meter_quick(int n)
+{
+	unsigned char seq, cnt = 0;
+	unsigned int x = 0;
+	
+	ATOMIC_BLOCK(ATOMIC_FORCEON)
+	{
+		meter_restart(0);
+		seq = meter_seq[0];
+	}
+	
+	while(cnt < n)
+	{
+		adc_nr_sample();
+		ATOMIC_BLOCK(ATOMIC_FORCEON)
+		{
+			if(meter_seq[0] != seq) //Block completed meanwhile
+			{
+				x = meter_dec[0];
+				cnt = METER_OVERSAMPLE;
+			}
+			else
+			{
+				x = meter_acc[0];
+				cnt = meter_n[0];
+			}
+		}
+	}
+	
+	return (x + (cnt >> 1)) / cnt;
+}	
+
+//Convert ADC2 in ADC noise reduction sleep mode when enabled and due.
+//Call only between bus transfers to DDS and LCD.
+void adc_nr_sample(void)
+{
+	unsigned int cnt;
+	unsigned char woke_early;
+	
+	if(!adc_nr_mode || adc_nr_due < ADC_NR_DIV)
+	{
+		return;
+	}
+	adc_nr_due = 0;
+	
+	//Stop Timer0 triggered conversions and wait for running one
+	hal_adc_halt();
+	
+	adc_nr_active = 1;
+	hal_adc_select(2);
+	
+	//Entering sleep mode starts the conversion, ADC ISR wakes CPU
+	set_sleep_mode(SLEEP_MODE_ADC);
+	cli();
+	sleep_enable();
+	sei();
+	sleep_cpu();
+	sleep_disable();
+	
+	//Woken up by other interrupt: clkIO and Timer1 run again for the rest of the
+	//conversion, the unknown time asleep before is not made up (< 0.1ms)
+	woke_early = adc_nr_active;
+	while(adc_nr_active);
+	
+	//Timer1 was halted for the whole conversion, catch up
+	cli();
+	if(!woke_early)
+	{
+		adc_nr_lost += ADC_NR_CYCLES;
+		cnt = hal_clock_count() + (adc_nr_lost >> 6); //Prescaler 64
+		adc_nr_lost &= 63;
+		while(cnt > CLOCK_TOP)
+		{
+			cnt -= CLOCK_TOP + 1;
+			clock_ms++;
+		}
+		hal_clock_set_count(cnt);
+	}
+	
+	//Resume schedule
+	hal_adc_select(adc_schedule[adc_sched_pos]);
+	hal_adc_resume();
+	sei();
+}	
+
+//Variance statistics of ADC2, called from ADC ISR
+void adc2_stat(int val)
+{
+	adc2_stat_sum += val;
+	adc2_stat_sq += (unsigned long) val * val;
+	
+	if(++adc2_stat_n >= ADC2_STAT_N)
+	{
+		adc2_var_d = ADC2_STAT_N * adc2_stat_sq - adc2_stat_sum * adc2_stat_sum;
+		adc2_mean_sum = adc2_stat_sum;
+		adc2_stat_n = 0;
+		adc2_stat_sum = 0;
+		adc2_stat_sq = 0;
+	}
+}		
+
+//Key number for ADC0 value, 0 if no key
+int decode_key(int adcval)
+{
+    int t1;
+    		
+    for(t1 = 0; t1 < 4; t1++)
+    {
+        if(adcval > key_value[t1] - 3 && adcval < key_value[t1] + 3)
+        {
+             return t1 + 1;
+        }
+    }
+    return 0;
+}
+
+//Debounce, press, release, long press and auto repeat, called from ADC ISR
+void keypad_scan(int adcval)
+{
+	int k = decode_key(adcval);
+	
+	if(k != key_raw)
+	{
+		key_raw = k;
+		key_cnt = 0;
+	}
+	else
+	{
+		if(key_cnt < KEY_DEBOUNCE)
+		{
+			key_cnt++;
+		}
+		
+		if(key_cnt == KEY_DEBOUNCE && k != key_state)
+		{
+			if(key_state)
+			{
+				push_key_event(KEY_EV_RELEASE | key_state);
+			}
+			key_state = k;
+			key_hold = 0;
+			if(k)
+			{
+				push_key_event(KEY_EV_PRESS | k);
+			}
+			return;
+		}		
+	}
+	
+	//Count up to the long press, on to repeats only if someone wants them
+	if(key_state && (key_hold < KEY_LONG_TIME || key_repeat))
+	{
+		key_hold++;
+		if(key_hold == KEY_LONG_TIME)
+		{
+			push_key_event(KEY_EV_LONG | key_state);
+		}
+		
+		if(key_hold >= KEY_LONG_TIME + KEY_REPEAT_TIME)
+		{
+			push_key_event(KEY_EV_REPEAT | key_state);
+			key_hold = KEY_LONG_TIME;
+		}
+	}	
+}
+
+//Put event into queue, dropped if queue is full
+void push_key_event(int ev)
+{
+	unsigned char next = (key_q_head + 1) % KEY_QUEUE_LEN;
+	
+	if(next != key_q_tail)
+	{
+		key_queue[key_q_head] = ev;
+		key_q_head = next;
+		post_event(EV_KEY);
+	}
+}	
+
+//Next event from queue or 0
+int get_key_event(void)
+{
+	int ev = 0;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if(key_q_tail != key_q_head)
+		{
+			ev = key_queue[key_q_tail];
+			key_q_tail = (key_q_tail + 1) % KEY_QUEUE_LEN;
+		}
+	}
+	
+	return ev;
+}
+
+//Next event of the types given or 0, other events are dropped.
+//A press returns the key number, other types the event.
+int get_key_input(int types)
+{
+	int ev;
+	
+	while((ev = get_key_event()))
+	{
+		if(ev & types)
+		{
+			return (ev & KEY_EV_PRESS) ? ev & 0x0F : ev;
+		}
+	}
+	
+	return 0;
+}	
+
+//Number of next pressed key or 0, other events are dropped
+int get_key_press(void)
+{
+	return get_key_input(KEY_EV_PRESS);
+}	
+
+void flush_key_events(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		key_q_tail = key_q_head;
+		events &= ~EV_KEY;
+	}
+}	
+
+//Key currently held down (debounced) or 0
+int get_keys(void)
+{
+	return key_state;
+}
+
+//Measure temperature of final amplifier
+//Sensor = KTY81-210, table from kty81.py, result in 1/10 deg C
+int get_temp(void)
+{
+	int adcval = get_adc(4);
+	int t1, frac;
+	
+	if(adcval <= KTY_ADC_MIN)
+	{
+		return kty81_table[0];
+	}
+	
+	t1 = (adcval - KTY_ADC_MIN) >> KTY_ADC_SHIFT;
+	if(t1 >= KTY_TABLE_LEN - 1)
+	{
+		return kty81_table[KTY_TABLE_LEN - 1];
+	}
+	
+	//Interpolate between 2 table entries
+	frac = (adcval - KTY_ADC_MIN) & ((1 << KTY_ADC_SHIFT) - 1);
+	
+	return kty81_table[t1] + (((kty81_table[t1 + 1] - kty81_table[t1]) * frac) >> KTY_ADC_SHIFT);
+}	
+
+  /////////////////////////
+ // INTERRUPT HANDLERS  //
+/////////////////////////
+//Rotary encoder, any edge on PD2 (INT0) or PD3 (INT1)
+//2 quarter steps make 1 step (as many as edges on PD2)
+ISR(INT0_vect)
+{ 
+    unsigned char state = (hal_port_in(PIND) & 0x0C) >> 2; // Read PD2 and PD3
+    signed char dir = 0;
+    unsigned int now, dt, hz;
+    
+    enc_sub += enc_table[(enc_state << 2) | state];
+    enc_state = state;
+    
+    if(enc_sub >= 2) 
+    {
+		enc_sub -= 2;
+		dir = 1;
+	}
+	
+	if(enc_sub <= -2) 
+    {
+		enc_sub += 2;
+		dir = -1;
+	}
+	
+	if(!dir)
+	{
+		return;
+	}
+	enc_count += dir;
+	
+	//Rate of rotation, slow down at once on reversal or after a pause
+	now = get_fine_ticks();
+	dt = now - enc_last_tick;
+	enc_last_tick = now;
+	if(dt > ENC_PERIOD_MAX || dir != enc_dir)
+	{
+		enc_period = ENC_PERIOD_MAX;
+	}
+	else
+	{
+	    enc_period = (enc_period * 3 + dt) >> 2;
+	}
+	enc_dir = dir;
+	
+	hz = accel_step_hz(enc_period);
+	enc_hz += (dir > 0) ? (long) hz : -(long) hz;
+	if(hz > enc_grid)
+	{
+		enc_grid = hz;
+	}
+	
+	if(!tlat_pending)
+	{
+		tlat_stamp = get_clock_ticks();
+		tlat_pending = 1;
+	}	
+	
+	post_event(EV_ENC);	
+}
+
+ISR(INT1_vect, ISR_ALIASOF(INT0_vect));
+
+//Clock
+ISR(TIMER1_COMPA_vect)
+{
+    clock_ms++;
+    events |= EV_TICK;
+    
+    //Switch settled in other state during debounce time
+    if((hal_port_in(PIND) ^ pin_state) & PIN_MASK)
+    {
+		pin_update();
+	}	
+}
+
+//PTT (PD0) or sideband switch (PD1)
+ISR(PCINT3_vect)
+{
+    pin_update();
+}
+
+//ADC conversion complete: store value and switch MUX to next channel in schedule
+ISR(ADC_vect)
+{
+	int ch = adc_schedule[adc_sched_pos];
+	int val = hal_adc_value();
+	
+	if(adc_nr_active) //Conversion from adc_nr_sample()
+	{
+		adc_slot[2] = val;
+		meter_sample(0, val);
+		adc2_stat(val);
+		adc_nr_active = 0;
+		return;
+	}	
+	
+	if(ch == 2 && adc_nr_mode) //ADC2 is converted in NR sleep mode, drop this one
+	{
+		if(adc_nr_due < 255)
+		{
+			adc_nr_due++;
+		}	
+	}
+	else
+	{	
+		adc_slot[ch] = val;
+		if(ch == 2 || ch == 3)
+		{
+			meter_sample(ch - 2, val);
+		}
+		if(ch == 2)
+		{
+			adc2_stat(val);
+		}	
+		if(!ch)
+		{
+			keypad_scan(val);
+		}
+	}
+	
+	if(++adc_sched_pos >= ADC_SCHEDULE_LEN)
+	{
+		adc_sched_pos = 0;
+	}
+	hal_adc_select(adc_schedule[adc_sched_pos]);
+	hal_adc_rearm();
+}
+
+//ms since start
+unsigned long get_clock_ms(void)
+{
+	unsigned long ms;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ms = clock_ms;
+	}
+	
+	return ms;
+}	
+
+//Time since start in 4us ticks, wraps after 4.7h
+unsigned long get_clock_ticks(void)
+{
+	unsigned long ms;
+	unsigned int cnt;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ms = clock_ms;
+		cnt = hal_clock_count();
+		if(hal_clock_pending() && cnt < (CLOCK_TOP >> 1)) //Compare match not yet serviced
+		{
+			ms++;
+		}
+	}
+	
+	return ms * (CLOCK_TOP + 1) + cnt;
+}	
+
+//ms elapsed since time t, valid across wrap of clock
+unsigned long clock_since(unsigned long t)
+{
+	return get_clock_ms() - t;
+}	
+
+//Periodic task: 1 if interval has elapsed since *t, *t moves on by interval.
+//Restarts from now if more than one interval was missed (e. g. in menu).
+int clock_due(unsigned long *t, unsigned long interval)
+{
+	unsigned long now = get_clock_ms();
+	
+	if(now - *t < interval)
+	{
+		return 0;
+	}
+	
+	*t += interval;
+	if(now - *t >= interval)
+	{
+		*t = now;
+	}
+	
+	return 1;
+}	
+
+  ////////////////////////////////////////////
+ //    Store or recall Frequency handling //
+//////////////////////////////////////////
+int is_mem_freq_ok(unsigned long f)
+{
+	if(f >= 13900000 && f <= 14400000)
+	{
+		return 1;
+	}	
+	else
+	{
+		return 0;
+	}		
+}	
+
+//Scan==0: scan memories, scan=1: scan band
+long scan(int mode)
+{
+    int t1 = 0, mem;
+    long f0;
+    unsigned long t0, t_hit;
+    int key = 0;
+    int sval, s_peak, hit;
+    int excl_next = 0;
+    unsigned long t_msg = 0;
+    
+    flush_key_events();
+    
+    if(!mode)
+    {
+		key = 0;
+		mem = -1;
+        while(key != 1 && key != 2) //Scan memories in order of frequency
+	    {
+		    t1 = 0;
+		    while(t1 < mem_count && !key)
+		    {
+			    sval = prio_look(PRIO_EVERY_MEM);
+			    if(sval)
+			    {
+					key = prio_hold(sval);
+					if(key == 2)
+					{
+						mem = prio_mem;
+					}
+					continue;
+				}
+				
+			    mem = mem_index[t1];
+			    f0 = load_mem_freq(mem);
+				if(!mem_locked(mem))
+				{
+					set_frequency1(f0);
+				    show_frequency(f0);
+				    show_mem_addr(mem, 0);
+				    				    
+				    sval = get_meter_fresh(2); //ADC voltage on ADC2 SVAL
+				    show_meter(sval); //S-Meter
+				    s_peak = sval;
+				    t_hit = get_clock_ms();
+				    hit = sval > s_threshold;
+				    while(sval > s_threshold && !key)
+				    {
+		 	            t0 = get_clock_ms();
+		 	            key = get_key_press();
+		 	            while(clock_since(t0) < 100 && !key)
+		 	            {
+							key = get_key_press();
+					    }	
+		 	            sval = get_meter(2);
+		 	            show_meter(sval); //S-Meter
+		 	            if(sval > s_peak)
+		 	            {
+							s_peak = sval;
+						}
+		 	        }
+		 	        if(hit)
+		 	        {
+						hitlog_add(f0, s_peak, t_hit);
+					}
+					
+				    t0 = get_clock_ms();
+				    while(clock_since(t0) < 2000 && !key)
+			        {
+						key = get_key_press();
+						sval = get_meter(2);
+		 	            show_meter(sval); //S-Meter
+					}	
+			    } 
+			    else  
+			    {
+					key = get_key_press();
+				}	
+				
+				if(key == 4) //Lock out this memory for good
+				{
+					store_mem_flags(mem, load_mem_flags(mem) | MEMFLAG_SKIP);
+					key = 0;
+				}	
+				t1++;
+				reset_smax();
+			}
+			
+			if(!mem_count) //Nothing to scan
+			{
+				key = get_key_press();
+			}	
+		}
+				
+		flush_key_events();
+		if(hitlog_eep)
+		{
+			hitlog_flush();
+		}
+				
+		if(key == 2 && mem > -1)
+		{
+			return(mem); //Set this memory frequency as new operating QRG
+		}
+		else
+		{
+			return(-1);
+		}	
+	}
+	
+	if(mode == 1)  //Scan band
+	{
+		f0 = excl_skip(scanfreq[0], scan_step_hz[scan_step], &excl_next);
+		t0 = get_clock_ms();
+		show_frequency(f0);
+		
+	    while(!key) 
+	    {
+			sval = prio_look(PRIO_EVERY_BAND);
+			if(sval)
+			{
+				key = prio_hold(sval);
+				if(key == 2)
+				{
+					f0 = prio_f;
+				}
+				t0 = get_clock_ms();
+				continue;
+			}
+			
+	        set_frequency1(f0);
+	        sval = scan_dwell();
+	        
+	        //Display follows at its own pace, not every step
+	        if(clock_due(&t0, SCAN_SHOW_MS))
+	        {
+			    show_frequency(f0);
+			    show_meter(sval); //S-Meter
+			}
+			if(t_msg && clock_since(t_msg) >= SCAN_MSG_MS)
+			{
+				show_meter_scale(0);
+				t_msg = 0;
+			}
+			
+			if(sval > s_threshold)
+			{
+				key = scan_hold(f0, sval);
+				if(key == SCAN_EXCLUDE) //Exclude this carrier from now on
+				{
+					if(!excl_add(f0, f0 + EXCL_WIDTH))
+					{
+						lcd_putstring(0, 5, "              ", 0, 0);
+						lcd_putstring(0, 5, "EXCL FULL", 0, 1);
+						t_msg = get_clock_ms() | 1; //Not 0
+					}	
+					excl_next = 0;
+					key = 0;
+				}	
+				t0 = get_clock_ms();
+			}
+		    if(!key)
+		    {
+		        key = get_key_press();
+		    }
+		    if(!key)
+		    {
+				f0 = excl_skip(f0 + scan_step_hz[scan_step], scan_step_hz[scan_step], &excl_next);
+				if(f0 > scanfreq[1])
+				{
+					excl_next = 0;
+					f0 = excl_skip(scanfreq[0], scan_step_hz[scan_step], &excl_next);
+				}
+			}
+		}
+								
+		flush_key_events();
+		if(hitlog_eep)
+		{
+			hitlog_flush();
+		}
+				
+		if(key == 2)
+		{
+			return(f0); //Set this frequency as new operating QRG
+		}
+		else
+		{
+			return(-1);
+		}			
+	}				    
+	return(-1);
+}	
+
+//S-meter value of a band scan step, short dwell on empty steps,
+//lengthened when the value comes near s_threshold
+int scan_dwell(void)
+{
+	int sval;
+	
+	get_meter_quick(SCAN_SETTLE); //Discard samples while IF filter and AGC settle
+	sval = get_meter_quick(SCAN_DWELL);
+	if(sval > s_threshold - SCAN_NEAR)
+	{
+		sval = get_meter_quick(SCAN_DWELL_LONG);
+	}
+	
+	return sval;
+}	
+
+//Band scan stopped on a signal, returns key or 0 to resume by scan_resume policy.
+//Key 4 resumes when released, held for a long press it returns SCAN_EXCLUDE.
+int scan_hold(long f, int sval)
+{
+	unsigned long t_stop = get_clock_ms();
+	unsigned long t_gone = t_stop, t_show = t_stop;
+	int key = 0;
+	int s_peak = sval;
+	int held = 0; //Key 4 down, no resume by policy until it is released
+	
+	show_frequency(f);
+	show_meter(sval); //S-Meter
+	
+	while(!key)
+	{
+		if(sval > s_threshold)
+		{
+			t_gone = get_clock_ms();
+		}
+		
+		if(!held && scan_resume == SCAN_RESUME_TIME && clock_since(t_stop) >= SCAN_HOLD_MS)
+		{
+			break;
+		}
+		if(!held && scan_resume != SCAN_RESUME_HOLD && clock_since(t_gone) >= SCAN_HANG_MS)
+		{
+			break;
+		}
+		
+		if(clock_due(&t_show, 100))
+		{
+			sval = get_meter(2);
+			show_meter(sval); //S-Meter
+			if(sval > s_peak)
+			{
+				s_peak = sval;
+			}
+		}
+		
+		//Key 4: resume on release, exclude on long press
+		key = get_key_input(KEY_EV_PRESS | KEY_EV_RELEASE | KEY_EV_LONG);
+		if(key == 4)
+		{
+			held = 1;
+			key = 0;
+		}
+		else if(key == (KEY_EV_RELEASE | 4) && held)
+		{
+			key = 0;
+			break;
+		}
+		else if(key & (KEY_EV_RELEASE | KEY_EV_LONG))
+		{
+			key = (key == SCAN_EXCLUDE && held) ? key : 0;
+		}
+	}
+	
+	hitlog_add(f, s_peak, t_stop);
+	
+	return key;
+}		
+
+//FTW of f with current sideband, calculated only if f or sideband of slot have changed
+unsigned long ftw_cached(int slot, unsigned long f)
+{
+	if(f != ftw_f[slot] || sideband != ftw_sb[slot])
+	{
+		ftw_f[slot] = f;
+		ftw_sb[slot] = sideband;
+		ftw_val[slot] = calc_ftw1(f, sideband);
+	}
+	return ftw_val[slot];
+}	
+
+//Send a precomputed FTW to DDS1
+void dds1_hop(unsigned long ftw)
+{
+	dds_busy = 1;
+	dds1_send_ftw(ftw);
+	dds_busy = 0;
+	dds_catch_up();
+}	
+
+//S-value at a precomputed FTW, DDS1 stays there
+int look_at(unsigned long ftw)
+{
+	dds1_hop(ftw);
+	get_meter_quick(SCAN_SETTLE); //Discard samples while IF filter and AGC settle
+	return get_meter_quick(PRIO_SAMPLES);
+}	
+
+//Look at priority channel every n-th call from scan(), returns S-value if above s_threshold, else 0
+int prio_look(int every)
+{
+	int sval;
+	
+	if(prio_mem < 0 || ++prio_n < every)
+	{
+		return 0;
+	}
+	prio_n = 0;
+	
+	sval = look_at(ftw_cached(FTW_PRIO, prio_f));
+	return (sval > s_threshold) ? sval : 0;
+}		
+
+//Scan stopped on priority channel, returns key like scan_hold(), key 4 resumes, never excludes
+int prio_hold(int sval)
+{
+	int key;
+	
+	set_frequency1(prio_f);
+	show_frequency(prio_f);
+	show_mem_addr(prio_mem, 0);
+	key = scan_hold(prio_f, sval);
+	
+	return (key == SCAN_EXCLUDE) ? 0 : key;
+}	
+
+//Set priority channel, -1 for none
+void set_prio_mem(int mem)
+{
+	prio_mem = mem;
+	prio_f = (mem >= 0) ? load_mem_freq(mem) : 0;
+	prio_n = 0;
+	eeprom_write_byte((uint8_t*)156, (mem >= 0) ? mem : 255);
+}	
+
+//Exclusion ranges from EEPROM
+void excl_load(void)
+{
+	int t1;
+	
+	excl_count = eeprom_read_byte((uint8_t*)EXCL_EEP_ADR);
+	if(excl_count > EXCL_MAX)
+	{
+		excl_count = 0;
+	}
+	for(t1 = 0; t1 < excl_count; t1++)
+	{
+		excl_lo[t1] = load_frequency_adr(EXCL_EEP_ADR + 4 + t1 * 8);
+		excl_hi[t1] = load_frequency_adr(EXCL_EEP_ADR + 8 + t1 * 8);
+	}
+}		
+
+//Only bytes that changed are written, i.e. the slots from the new or merged range on
+void excl_store(void)
+{
+	int t1;
+	
+	for(t1 = 0; t1 < excl_count; t1++)
+	{
+		store_frequency_adr(excl_lo[t1], EXCL_EEP_ADR + 4 + t1 * 8);
+		store_frequency_adr(excl_hi[t1], EXCL_EEP_ADR + 8 + t1 * 8);
+	}
+	eeprom_update_byte((uint8_t*)EXCL_EEP_ADR, excl_count);
+}		
+
+//Add range lo..hi, merged with ranges it overlaps. Returns 0 if no room.
+int excl_add(long lo, long hi)
+{
+	int t1, t2;
+	
+	for(t1 = 0; t1 < excl_count; )
+	{
+		if(excl_lo[t1] <= hi && excl_hi[t1] >= lo)
+		{
+			if(excl_lo[t1] < lo)
+			{
+				lo = excl_lo[t1];
+			}
+			if(excl_hi[t1] > hi)
+			{
+				hi = excl_hi[t1];
+			}
+			for(t2 = t1; t2 < excl_count - 1; t2++)
+			{
+				excl_lo[t2] = excl_lo[t2 + 1];
+				excl_hi[t2] = excl_hi[t2 + 1];
+			}
+			excl_count--;
+		}
+		else
+		{
+			t1++;
+		}
+	}
+	
+	if(excl_count >= EXCL_MAX)
+	{
+		return 0;
+	}
+	
+	for(t1 = excl_count; t1 > 0 && excl_lo[t1 - 1] > lo; t1--)
+	{
+		excl_lo[t1] = excl_lo[t1 - 1];
+		excl_hi[t1] = excl_hi[t1 - 1];
+	}
+	excl_lo[t1] = lo;
+	excl_hi[t1] = hi;
+	excl_count++;
+	excl_store();
+	
+	return 1;
+}		
+
+//First frequency f + n * step outside the exclusion ranges. *next is the first range not
+//yet passed, it only moves up while the scan steps up, so a step costs one compare
+//unless it enters a range, which is then jumped over at once.
+long excl_skip(long f, long step, int *next)
+{
+	while(*next < excl_count && f >= excl_lo[*next])
+	{
+		if(f <= excl_hi[*next])
+		{
+			f += ((excl_hi[*next] - f) / step + 1) * step;
+		}
+		(*next)++;
+	}
+	
+	return f;
+}		
+
+  //////////////////////
+ //  SCAN HIT LOG    //
+//////////////////////
+//Record a stop of scan at f since clock_ms t_stop
+void hitlog_add(long f, int s_peak, unsigned long t_stop)
+{
+	unsigned long dwell = clock_since(t_stop) / 100;
+	
+	hit_f[hit_pos] = f;
+	hit_t[hit_pos] = t_stop / 100;
+	hit_dwell[hit_pos] = (dwell > 0xFFFF) ? 0xFFFF : dwell;
+	hit_s[hit_pos] = (s_peak > 255) ? 255 : s_peak;
+	hit_pos = (hit_pos + 1) % HITLOG_LEN;
+	if(hit_count < HITLOG_LEN)
+	{
+		hit_count++;
+	}
+	else if(hit_prev)
+	{
+		hit_prev--;
+	}
+	if(hit_unsaved < HITLOG_LEN)
+	{
+		hit_unsaved++;
+	}
+}	
+
+//Append unsaved records to the ring in EEPROM, oldest first
+void hitlog_flush(void)
+{
+	unsigned char pos, n;
+	int t1;
+	uint8_t *adr;
+	
+	if(!hit_unsaved)
+	{
+		return;
+	}
+	
+	pos = eeprom_read_byte((uint8_t*)HITLOG_EEP_ADR + 2);
+	n = eeprom_read_byte((uint8_t*)HITLOG_EEP_ADR + 3);
+	if(eeprom_read_byte((uint8_t*)HITLOG_EEP_ADR) != 'H' || eeprom_read_byte((uint8_t*)HITLOG_EEP_ADR + 1) != 'L' ||
+	   pos >= HITLOG_EEP_LEN || n > HITLOG_EEP_LEN)
+	{
+		pos = 0;
+		n = 0;
+	}
+	
+	while(hit_unsaved)
+	{
+		t1 = (hit_pos + HITLOG_LEN - hit_unsaved) % HITLOG_LEN;
+		adr = (uint8_t*)HITLOG_EEP_ADR + 4 + pos * HITREC_SIZE;
+		eeprom_write_block(&hit_f[t1], adr, 4);
+		eeprom_write_block(&hit_t[t1], adr + 4, 4);
+		eeprom_write_block(&hit_dwell[t1], adr + 8, 2);
+		eeprom_write_byte(adr + 10, hit_s[t1]);
+		pos = (pos + 1) % HITLOG_EEP_LEN;
+		if(n < HITLOG_EEP_LEN)
+		{
+			n++;
+		}
+		hit_unsaved--;
+	}
+	
+	eeprom_update_byte((uint8_t*)HITLOG_EEP_ADR, 'H');
+	eeprom_update_byte((uint8_t*)HITLOG_EEP_ADR + 1, 'L');
+	eeprom_write_byte((uint8_t*)HITLOG_EEP_ADR + 2, pos);
+	eeprom_write_byte((uint8_t*)HITLOG_EEP_ADR + 3, n);
+}		
+
+//Fill RAM ring with the newest records in EEPROM after power on
+void hitlog_load(void)
+{
+	unsigned char pos, n;
+	uint8_t *adr;
+	
+	pos = eeprom_read_byte((uint8_t*)HITLOG_EEP_ADR + 2);
+	n = eeprom_read_byte((uint8_t*)HITLOG_EEP_ADR + 3);
+	if(eeprom_read_byte((uint8_t*)HITLOG_EEP_ADR) != 'H' || eeprom_read_byte((uint8_t*)HITLOG_EEP_ADR + 1) != 'L' ||
+	   pos >= HITLOG_EEP_LEN || n > HITLOG_EEP_LEN)
+	{
+		return;
+	}
+	if(n > HITLOG_LEN)
+	{
+		n = HITLOG_LEN;
+	}
+	
+	pos = (pos + HITLOG_EEP_LEN - n) % HITLOG_EEP_LEN;
+	while(n--)
+	{
+		adr = (uint8_t*)HITLOG_EEP_ADR + 4 + pos * HITREC_SIZE;
+		hit_f[hit_pos] = ((unsigned long) eeprom_read_word((uint16_t*)(adr + 2)) << 16) | eeprom_read_word((uint16_t*)adr);
+		hit_t[hit_pos] = ((unsigned long) eeprom_read_word((uint16_t*)(adr + 6)) << 16) | eeprom_read_word((uint16_t*)(adr + 4));
+		hit_dwell[hit_pos] = eeprom_read_word((uint16_t*)(adr + 8));
+		hit_s[hit_pos] = eeprom_read_byte(adr + 10);
+		hit_pos = (hit_pos + 1) % HITLOG_LEN;
+		hit_count++;
+		pos = (pos + 1) % HITLOG_EEP_LEN;
+	}
+	hit_prev = hit_count;
+}		
+
+//Hits newest first, key 4 switches between peak S, dwell in s and time of stop
+//in minutes since power on ("--" for hits of an earlier power on).
+//Key 2 tunes the current VFO to the hit in the top line.
+void show_hit_log(void)
+{
+	lcd_cls(0, 83, 0, 47);
+	
+	scr_arg = 0; //Column
+	scr_pos = 0; //First line
+	hit_log_step(0, 0);
+	screen_open(SCR_HITS);
+}	
+
+//Hit log screen, keys 1 and 3 leave
+int hit_log_step(int key, int steps)
+{
+	int t1, t2;
+	
+	if(key == 4)
+	{
+		scr_arg = (scr_arg + 1) % 3;
+	}
+	else if(key)
+	{
+		if(key == 2 && scr_pos < hit_count)
+		{
+			t2 = (hit_pos + HITLOG_LEN - 1 - scr_pos) % HITLOG_LEN;
+			if(is_mem_freq_ok(hit_f[t2]))
+			{
+				set_vfo_frequency(hit_f[t2], 0, 1);
+			}
+		}
+		return 1;
+	}
+	
+	scr_pos = limit_step(scr_pos, steps, 1, 0, (hit_count > 5) ? hit_count - 5 : 0);
+	
+	lcd_putstring(0, 0, hit_head[scr_arg], 0, 1);
+	for(t1 = 0; t1 < 5; t1++)
+	{
+		lcd_putstring(0, t1 + 1, "              ", 0, 0);
+		if(scr_pos + t1 >= hit_count)
+		{
+			continue;
+		}
+		t2 = (hit_pos + HITLOG_LEN - 1 - scr_pos - t1) % HITLOG_LEN;
+		lcd_putnumber(0, t1 + 1, hit_f[t2] / 100, 1, 0, 0);
+		switch(scr_arg)
+		{
+			case 0: lcd_putnumber(54, t1 + 1, hit_s[t2], -1, 0, 0);
+			        break;
+			case 1: lcd_putnumber(54, t1 + 1, hit_dwell[t2] / 10, -1, 0, 0);
+			        break;
+			case 2: if(scr_pos + t1 >= hit_count - hit_prev)
+			        {
+			            lcd_putstring(54, t1 + 1, "--", 0, 0);
+			        }
+			        else
+			        {
+			            lcd_putnumber(54, t1 + 1, hit_t[t2] / 600, -1, 0, 0);
+			        }
+			        break;
+		}
+	}
+	
+	return 0;
+}		
+
+  /////////////////
+ //  BANDSCOPE  //
+/////////////////
+//Bar height in pixels of an S-value
+int scope_height(int sval)
+{
+	int h = (long) sval * SCOPE_ROWS * 8 / SCOPE_FULL;
+	
+	if(h > SCOPE_ROWS * 8)
+	{
+		h = SCOPE_ROWS * 8;
+	}
+	return h;
+}	
+
+//Column byte of a bar with fill pixels in this row, LSB is top pixel
+unsigned char scope_byte(int fill)
+{
+	if(fill <= 0)
+	{
+		return 0;
+	}
+	if(fill >= 8)
+	{
+		return 0xFF;
+	}
+	return 0xFF << (8 - fill);
+}	
+
+//Bar of height h in column x, sends only rows that differ from a bar of height h_old,
+//all rows if h_old < 0. The cursor column is drawn inverted dotted.
+void scope_column(int x, int h_old, int h, int cursor)
+{
+	int r, k;
+	unsigned char b;
+	
+	for(r = 0; r < SCOPE_ROWS; r++)
+	{
+		k = (SCOPE_ROWS - 1 - r) * 8; //Pixels below this row
+		b = scope_byte(h - k);
+		if(h_old < 0 || b != scope_byte(h_old - k))
+		{
+			lcd_gotoxy(x, r + 1);
+			lcd_senddata(cursor ? b ^ 0x55 : b);
+		}
+	}
+}		
+
+//Cursor frequency in kHz and bin width in Hz
+void scope_head(long f, int span)
+{
+	lcd_putstring(0, 0, "              ", 0, 0);
+	lcd_putnumber(0, 0, f / 100, 1, 0, 0);
+	lcd_putnumber(54, 0, scan_step_hz[span], -1, 0, 0);
+}	
+
+//Sweeps around fc and draws the spectrum bin by bin, the encoder moves the cursor,
+//key 4 changes the span. Key 2 tunes the current VFO to the cursor frequency.
+void bandscope(long fc)
+{
+	lcd_cls(0, 84, 0, 6);
+	scope_start(fc);
+	screen_open(SCR_SCOPE);
+}		
+
+//New sweep with the cursor in the middle at fc
+void scope_start(long fc)
+{
+	int b;
+	
+	for(b = 0; b < SCOPE_BINS; b++)
+	{
+		scope_val[b] = 0;
+	}
+	scr_arg = 0;
+	scr_pos = SCOPE_BINS / 2;
+	scr_val = fc - (long) scr_pos * scan_step_hz[scope_span];
+	
+	lcd_cls(0, 84, 1, 1 + SCOPE_ROWS);
+	scope_column(scr_pos, -1, 0, 1);
+	scope_head(fc, scope_span);
+}	
+
+//Scope screen, one bin per tick, no sweep while transmitting. Keys 1 and 3 leave.
+int bandscope_step(int key, int steps)
+{
+	int b = scr_arg, cursor = scr_pos;
+	int sval, sval_old;
+	long fc = scr_val + (long) cursor * scan_step_hz[scope_span];
+	
+	if(key == 4) //Next span around cursor frequency
+	{
+		scope_span = wrap_step(scope_span, -1, SCAN_STEPS - 1);
+		scope_start(fc);
+		return 0;
+	}
+	if(key)
+	{
+		dds_peek = 0; //DDS1 goes home in screen_close()
+		if(key == 2 && is_mem_freq_ok(fc))
+		{
+			set_vfo_frequency(fc, 0, 1);
+		}
+		return 1;
+	}
+	
+	if(steps)
+	{
+		scr_pos = limit_step(cursor, steps, 1, 0, SCOPE_BINS - 1);
+		scope_column(cursor, -1, scope_height(scope_val[cursor]), 0);
+		scope_column(scr_pos, -1, scope_height(scope_val[scr_pos]), 1);
+		scope_head(scr_val + (long) scr_pos * scan_step_hz[scope_span], scope_span);
+		return 0;
+	}
+	
+	if(txrx)
+	{
+		return 0;
+	}
+	
+	//Next bin, redraw changed rows only. A PTT change meanwhile clears dds_peek
+	//and takes DDS1 home, the bin is measured again then.
+	dds_peek = 1;
+	set_frequency1(scr_val + (long) b * scan_step_hz[scope_span]);
+	get_meter_quick(SCAN_SETTLE); //Discard samples while IF filter and AGC settle
+	sval = get_meter_quick(SCAN_DWELL);
+	if(!dds_peek)
+	{
+		return 0;
+	}
+	if(sval > 255)
+	{
+		sval = 255;
+	}
+	sval_old = scope_val[b];
+	scope_val[b] = sval;
+	scope_column(b, scope_height(sval_old), scope_height(sval), b == cursor);
+	scr_arg = (b + 1) % SCOPE_BINS;
+	
+	return 0;
+}		
+
+  //////////////////////
+ //  SUPPLY VOLTAGE  //
+//////////////////////
+//Sample ADC1 and update statistics, result in 1/10 V
+void measure_voltage(void)
+{
+	//ADC * 5V / 1024 * volt_cal / 1000 * 10
+	voltage = ((unsigned long) get_adc(1) * volt_cal + 10240) / 20480;
+	
+	if(!volts_avg16)
+	{
+		reset_volt_stats();
+		return;
+	}	
+	
+	if(voltage < volts_min)
+	{
+		volts_min = voltage;
+	}
+	if(voltage > volts_max)
+	{
+		volts_max = voltage;
+	}
+	volts_avg16 += voltage - (volts_avg16 >> 4);
+}
+
+void reset_volt_stats(void)
+{
+	volts_min = voltage;
+	volts_max = voltage;
+	volts_avg16 = voltage << 4;
+}		
+
+//Calibrate voltage divider factor against a known supply voltage
+void set_volt_cal(void)
+{
+    lcd_cls(0, 83, 0, 47);
+    lcd_putstring(6, 0, " VOLT CALIB ", 0, 1);
+    
+    scr_pos = volt_cal;
+    volt_cal_step(0, 0);
+    screen_open(SCR_VCAL);
+}	
+
+//Calibration screen, voltage is redrawn on each tick. Key 2 confirms, other keys abort.
+int volt_cal_step(int key, int steps)
+{
+	int v;
+	
+	if(key)
+	{
+		if(key == 2)
+		{
+			volt_cal = scr_pos;
+			eeprom_write_word((uint16_t*)148, volt_cal);
+			reset_volt_stats();
+		}	
+		return 1;
+	}
+	
+	scr_pos = limit_step(scr_pos, steps, 5, 3000, 6000);
+	
+	v = ((unsigned long) get_adc(1) * (unsigned int) scr_pos + 10240) / 20480;
+	lcd_putstring(0, 2, "       ", 1, 0);
+	lcd_putnumber(0, 2, v, 1, 1, 0);
+	lcd_putstring(0, 5, "F=      ", 0, 0);
+	lcd_putnumber(12, 5, scr_pos, 3, 0, 0);
+	
+	return 0;
+}	
+
+//Threshold for low voltage display
+void set_volt_alarm(void)
+{
+    lcd_cls(0, 83, 0, 47);
+    lcd_putstring(6, 0, " VOLT ALARM ", 0, 1);
+    lcd_putnumber(0, 2, volt_alarm, 1, 1, 0);
+    
+    scr_pos = volt_alarm;
+    screen_open(SCR_VALARM);
+}	
+
+//Alarm screen, key 2 confirms, other keys abort
+int volt_alarm_step(int key, int steps)
+{
+    if(steps)
+	{
+		scr_pos = limit_step(scr_pos, steps, 1, 50, 200);
+		lcd_putstring(0, 2, "       ", 1, 0);
+        lcd_putnumber(0, 2, scr_pos, 1, 1, 0);
+	}
+	
+	if(!key)
+	{
+		return 0;
+	}
+	
+	if(key == 2)
+	{
+		volt_alarm = scr_pos;
+		eeprom_write_byte((uint8_t*)150, volt_alarm);
+	}	
+	
+	return 1;
+}	
+
+//Min, max and average voltage since power on as measured by task_volt(), key 4 resets
+void show_volt_stats(void)
+{
+	lcd_cls(0, 83, 0, 47);
+    lcd_putstring(6, 0, " VOLT STATS ", 0, 1);
+    
+    volt_stats_step(0, 0);
+    screen_open(SCR_VSTATS);
+}		
+
+//Statistics screen, redrawn on each tick. Keys 1..3 leave.
+int volt_stats_step(int key, int steps)
+{
+	if(key == 4)
+	{
+		reset_volt_stats();
+	}
+	else if(key)
+	{
+		return 1;
+	}
+	
+	lcd_putstring(0, 1, "NOW        ", 0, 0);
+	lcd_putnumber(30, 1, voltage, 1, 0, 0);
+	lcd_putstring(0, 2, "MIN        ", 0, 0);
+	lcd_putnumber(30, 2, volts_min, 1, 0, 0);
+	lcd_putstring(0, 3, "MAX        ", 0, 0);
+	lcd_putnumber(30, 3, volts_max, 1, 0, 0);
+	lcd_putstring(0, 4, "AVG        ", 0, 0);
+	lcd_putnumber(30, 4, (volts_avg16 + 8) >> 4, 1, 0, 0);
+	
+	return 0;
+}		
+
+//Toggle ADC noise reduction mode for S-meter, shows variance and mean
+//of ADC2 for comparison of both modes
+void set_adc_nr(void)
+{
+	lcd_cls(0, 83, 0, 47);
+    lcd_putstring(12, 0, " ADC2 NR ", 0, 1);
+    
+    scr_pos = adc_nr_mode;
+    adc_nr_step(0, 0);
+    screen_open(SCR_ADCNR);
+}	
+
+//NR screen, knob toggles the mode, which is in effect at once. The main loop takes
+//the samples, statistics are redrawn on each tick. Key 2 stores the mode, other keys
+//restore it.
+int adc_nr_step(int key, int steps)
+{
+	unsigned long d, v100;
+	
+	if(key)
+	{
+		if(key == 2)
+		{
+			eeprom_write_byte((uint8_t*)151, adc_nr_mode);
+		}
+		else
+		{
+			adc_nr_mode = eeprom_read_byte((uint8_t*)151) == 1;
+		}		
+		return 1;
+	}
+	
+	if(steps & 1)
+	{
+		scr_pos = !scr_pos;
+	}
+	adc_nr_mode = scr_pos;
+	
+	if(scr_pos)
+	{
+	    lcd_putstring(0, 1, "MODE SLEEP ", 0, 0);
+	}
+	else
+	{
+	    lcd_putstring(0, 1, "MODE NORMAL", 0, 0);
+	}
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+	    d = adc2_var_d;
+	}
+	    
+	//Variance in 1/100 LSB^2
+	v100 = (d / ((unsigned long) ADC2_STAT_N * ADC2_STAT_N)) * 100 + (d % ((unsigned long) ADC2_STAT_N * ADC2_STAT_N)) * 100 / ((unsigned long) ADC2_STAT_N * ADC2_STAT_N);
+	lcd_putstring(0, 3, "VAR        ", 0, 0);
+	lcd_putnumber(30, 3, v100, 2, 0, 0);
+	lcd_putstring(0, 4, "MEAN       ", 0, 0);
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+	    d = adc2_mean_sum;
+	}
+	lcd_putnumber(30, 4, d / ADC2_STAT_N, -1, 0, 0);
+	
+	return 0;
+}	
+
+//Select tuning acceleration curve, shows step sizes over rate of rotation
+void set_tuning_accel(void)
+{
+	lcd_cls(0, 83, 0, 47);
+    lcd_putstring(12, 0, " ACCEL ", 0, 1);
+    
+    scr_pos = tune_accel;
+    tuning_accel_step(0, 0);
+    screen_open(SCR_ACCEL);
+}	
+
+//Curve screen, key 2 selects the curve, other keys abort
+int tuning_accel_step(int key, int steps)
+{
+	int t1;
+	
+	if(key)
+	{
+		if(key == 2)
+		{
+			tune_accel = scr_pos;
+			eeprom_write_byte((uint8_t*)152, tune_accel);
+		}
+		return 1;
+	}
+	
+	scr_pos = wrap_step(scr_pos, steps, ACCEL_CURVES - 1);
+	
+	lcd_putstring(0, 1, "CURVE ", 0, 0);
+	lcd_putstring(36, 1, accel_str[scr_pos], 0, 0);
+	
+	//Step period in ms and step size
+	for(t1 = 1; t1 < ACCEL_LEN; t1++)
+	{
+		lcd_putstring(0, t1 + 1, "              ", 0, 0);
+		lcd_putstring(0, t1 + 1, "<", 0, 0);
+		lcd_putnumber(6, t1 + 1, accel_curve[scr_pos][t1][0] * 8L / 125, -1, 0, 0);
+		lcd_putstring(24, t1 + 1, "MS", 0, 0);
+		lcd_putnumber(42, t1 + 1, accel_curve[scr_pos][t1][1], -1, 0, 0);
+		lcd_putstring(66, t1 + 1, "HZ", 0, 0);
+	}
+	
+	return 0;
+}		
+
+//Scans 16 memories
+void set_scan_threshold(void)
+{
+	int xpos0 = 3;
+	int ypos0 = 0;
+    int thresh = s_threshold;
+    
+    lcd_cls(0, 83, 0, 47);
+    show_meter(thresh);
+    show_meter_scale(0);
+        
+    lcd_putstring(6, ypos0, " SCAN THRESH ", 0, 1);
+        
+    lcd_putstring(xpos0, ypos0 + 2, "  ", 0, 0);
+    lcd_putnumber(xpos0, ypos0 + 2, thresh, -1, 0, 0);
+    
+    scr_pos = thresh;
+    screen_open(SCR_THRESH);
+}	
+
+//Threshold screen, key 2 confirms, key 4 steps 10 (repeats while held), other keys abort
+int scan_threshold_step(int key, int steps)
+{
+	int xpos0 = 3;
+	int ypos0 = 0;
+	
+    if(steps)
+	{
+		scr_pos = limit_step(scr_pos, steps, 1, 0, 80);
+		show_meter(scr_pos);
+	
+        lcd_putstring(xpos0, ypos0 + 2, "  ", 0, 0);
+        lcd_putnumber(xpos0, ypos0 + 2, scr_pos, -1, 0, 0);
+	}
+	
+	if(!key)
+	{
+		return 0;
+	}
+	
+	if(key == 2)
+	{
+		s_threshold = scr_pos;
+		eeprom_write_byte((uint8_t*)129, s_threshold);
+	}	
+	
+	return 1;
+}	
+
+//Step size and resume policy of band scan, hit log storage and clearing of exclusion
+//ranges, key 4 selects the line
+void set_scan_config(void)
+{
+	lcd_cls(0, 83, 0, 47);
+	lcd_putstring(6, 0, " SCAN CONFIG ", 0, 1);
+	
+	scr_pos = 0; //Line
+	scr_opt[0] = scan_step;
+	scr_opt[1] = scan_resume;
+	scr_opt[2] = hitlog_eep;
+	scr_opt[3] = 0; //Clear exclusions
+	scan_config_step(0, 0);
+	screen_open(SCR_SCANCFG);
+}		
+
+//Config screen, knob changes the selected line, key 2 confirms, keys 1 and 3 abort
+int scan_config_step(int key, int steps)
+{
+	if(key == 4)
+	{
+		scr_pos = (scr_pos + 1) % 4;
+	}
+	else if(key)
+	{
+		if(key == 2)
+		{
+			scan_step = scr_opt[0];
+			scan_resume = scr_opt[1];
+			hitlog_eep = scr_opt[2];
+			eeprom_write_byte((uint8_t*)153, scan_step);
+			eeprom_write_byte((uint8_t*)154, scan_resume);
+			eeprom_write_byte((uint8_t*)155, hitlog_eep);
+			if(scr_opt[3])
+			{
+				excl_count = 0;
+				excl_store();
+			}
+		}
+		return 1;
+	}
+	
+	if(steps)
+	{
+		switch(scr_pos)
+		{
+			case 0: scr_opt[0] = wrap_step(scr_opt[0], steps, SCAN_STEPS - 1);
+			        break;
+			case 1: scr_opt[1] = wrap_step(scr_opt[1], steps, SCAN_RESUMES - 1);
+			        break;
+			case 2: 
+			case 3: scr_opt[scr_pos] = !scr_opt[scr_pos];
+			        break;
+		}
+	}
+	
+	lcd_putstring(0, 2, "STEP  ", 0, scr_pos == 0);
+	lcd_putstring(36, 2, "    ", 0, 0);
+	lcd_putnumber(36, 2, scan_step_hz[scr_opt[0]], -1, 0, 0);
+	lcd_putstring(66, 2, "HZ", 0, 0);
+	lcd_putstring(0, 3, "RESUME", 0, scr_pos == 1);
+	lcd_putstring(42, 3, scan_resume_str[scr_opt[1]], 0, 0);
+	lcd_putstring(0, 4, "LOG   ", 0, scr_pos == 2);
+	lcd_putstring(42, 4, scr_opt[2] ? "EEP " : "RAM ", 0, 0);
+	lcd_putstring(0, 5, "EXCL  ", 0, scr_pos == 3);
+	lcd_putstring(42, 5, "      ", 0, 0);
+	if(scr_opt[3])
+	{
+		lcd_putstring(42, 5, "CLEAR", 0, 0);
+	}
+	else
+	{
+	    lcd_putnumber(42, 5, excl_count, -1, 0, 0);
+	}    
+	
+	return 0;
+}		
+
+//Scans a frequency range defined by 2 edge frequencies
+void set_scan_frequency(int fpos, long f0)
+{
+	int xpos0 = 3;
+	int ypos0 = 0;
+    
+    lcd_cls(0, 83, 0, 47);
+        
+    lcd_putstring(xpos0, ypos0, "SET SCAN FREQ", 0, 1);
+    if(!fpos)
+    {
+        lcd_putstring(xpos0, ypos0 + 1, "FREQUENCY0:", 0, 0);
+    }   
+    else
+    {
+        lcd_putstring(xpos0, ypos0 + 1, "FREQUENCY1:", 0, 0);
+    }   
+        
+    show_frequency(f0);
+    
+    scr_arg = fpos;
+    scr_val = f0;
+    screen_open(SCR_SCANF);
+}
+
+//Scan limit screen, key 2 stores the limit, key 4 steps 10 kHz (repeats while held),
+//other keys leave it. Lower limit goes on to upper limit.
+int scan_frequency_step(int key, int steps)
+{
+	int fpos = scr_arg;
+	
+    if(steps)
+	{
+		scr_val -= 100L * steps;
+		if(scr_val > 14400000)
+		{
+			scr_val = 14400000;
+		}
+		if(scr_val < 0)
+		{
+			scr_val = 0;
+		}
+			
+        show_frequency(scr_val);
+        set_frequency1(scr_val);
+	}
+	
+	if(!key)
+	{
+		return 0;
+	}
+	
+	if(key == 2)
+	{
+		store_frequency(scr_val, 33 + fpos);
+		scanfreq[fpos] = scr_val;
+	}	
+	
+	if(!fpos)
+	{
+		set_scan_frequency(1, f_vfo[cur_vfo]);
+		return 0;
+	}
+	
+	return 1;
+}
+
+//Displays the data of the currently used main VFO
+int set_vfo(int xvfo, int xsplit)
+{
+    //Store values
+ 	store_frequency(f_vfo[0], 16); //VFO A
+	store_frequency(f_vfo[1], 17); //VFO B
+	    
+	show_vfo(xvfo, xsplit);
+	set_frequency1(f_vfo[xvfo]);
+	show_frequency(f_vfo[xvfo]);
+	store_last_vfo(xvfo);
+	
+    return xvfo;			        
+}	
+
+  //////////
+ // MENU //
+//////////
+void print_menu_head(int m)
+{	
+    int xpos0 = 3;
+	int ypos0 = 1;
+	char s[MENU_TEXTLEN];
+	int t1;
+		
+	lcd_cls(0, 84, 0, 48);
+	lcd_drawbox(34, 0, 80, menu_last[m] + 2);
+	for(t1 = 0; t1 < 2; t1++)
+	{
+		menu_copy(s, menu_head[m][t1]);
+		lcd_putstring(xpos0, ypos0 + t1, s, 0, 0);
+	}	
+}
+
+void print_menu_item(int m, int ypos, int inverted)
+{
+	int xpos1= 40;
+	char s[MENU_TEXTLEN];
+	
+	menu_copy(s, menu_text[m][ypos]);
+	lcd_putstring(xpos1, ypos + 1, s, 0, inverted);
+}
+	
+//Print the itemlist or single item
+void print_menu_item_list(int m, int item, int invert)
+{
+    int t1;
+    
+    if(item == -1)
+    {
+        //Print item list for menu
+	    for(t1 = 0; t1 < menu_last[m] + 1; t1++)
+	    {
+		    print_menu_item(m, t1, 0);   
+	    }	
+	}
+	else	
+	{
+		print_menu_item(m, item, invert);   
+	}	
+}
+
+//Copy menu text from flash for lcd_putstring()
+void menu_copy(char *s, const __flash char *src)
+{
+	int t1 = 0;
+	
+	do
+	{
+		s[t1] = src[t1];
+	}
+	while(s[t1++] && t1 < MENU_TEXTLEN);
+	s[MENU_TEXTLEN - 1] = 0;
+}
+
+//Open the menu tree at its first menu
+void menux(void)
+{
+	menu_show(0);
+	screen_open(SCR_MENU);
+}
+
+//Draw menu m with its first item selected
+void menu_show(int m)
+{
+	scr_arg = m;
+	scr_pos = 0;
+	print_menu_head(m);	                       //Head outline of menu
+	print_menu_item_list(m, -1, 0);            //Print item list in full
+	print_menu_item_list(m, 0, 1);             //Write 1st entry in reverse color
+}
+
+//Menu screen: knob selects item, key 2 runs it, key 3 quits,
+//other keys go on to menu_next[]
+int menu_step(int key, int steps)
+{
+	int m = scr_arg;
+	
+	if(steps)
+	{
+		print_menu_item_list(m, scr_pos, 0); //Write old entry in normal color
+		scr_pos = wrap_step(scr_pos, steps, menu_last[m]);
+		print_menu_item_list(m, scr_pos, 1); //Write new entry in reverse color
+	}
+	
+	if(!key)
+	{
+		return 0;
+	}
+	
+	flush_key_events();
+	
+	switch(key)
+	{
+		case 2: //Run the action, it may open a screen of its own. Main display is
+		        //drawn by screen_close() or by actions that need it underneath.
+		        screen = SCR_NONE;
+		        menu_run(m, scr_pos);
+		        return screen == SCR_NONE;
+		        
+		case 3: return 1; //Quit menu
+	}
+	
+	if(menu_next[m] == MENU_END)
+	{
+		return 1;
+	}
+	menu_show(menu_next[m]);
+	
+	return 0;
+}
+
+//Run the action of item of menu m
+void menu_run(int m, int item)
+{
+	menu_fn action = menu_action[m][item];
+	
+	if(action)
+	{
+		action();
+	}
+}		
+
+  ///////////////////
+ // MODAL SCREENS //
+///////////////////
+//Screen s gets keys and encoder steps from now on, its opener has drawn it
+void screen_open(int s)
+{
+	screen = s;
+	scr_dir = -1; //Up
+	scr_t = get_clock_ms();
+	key_repeat = screen_coarse[s] > 0;
+}
+
+//Step open screen with key pressed and encoder steps, back to main display when done
+void screen_input(int key, int steps)
+{
+	if(screen == SCR_NONE)
+	{
+		return;
+	}
+	
+	//Key 4 and its repeats step coarse in the direction the knob last turned where the screen
+	//has a coarse step, other repeats are dropped
+	if((key & 0x0F) == 4 && screen_coarse[screen])
+	{
+		steps = scr_dir * screen_coarse[screen];
+		key = 0;
+	}
+	else if(key & KEY_EV_REPEAT)
+	{
+		return;
+	}
+	else if(steps)
+	{
+		scr_dir = (steps < 0) ? -1 : 1;
+	}
+	
+	if(screen_func[screen](key, steps))
+	{
+		screen_close();
+	}
+}
+
+//Back to main display, DDS1 back from frequencies shown on a screen
+void screen_close(void)
+{
+	screen = SCR_NONE;
+	key_repeat = 0;
+	flush_key_events();
+	set_vfo_frequency(0, 0, 1);
+	lcd_cls(0, 83, 0, 47);
+	show_all_data(f_vfo[cur_vfo], sideband, voltage, last_memplace, cur_vfo, split);
+}
+
+//Menu actions
+void menu_vfo_a(void)
+{
+	cur_vfo = 0;
+	show_vfo(0, 0);
+	set_vfo_frequency(0, 0, 1);
+	show_frequency(f_vfo[cur_vfo]);
+}
+
+void menu_vfo_b(void)
+{
+	cur_vfo = 1;
+	show_vfo(1, 0);
+	set_vfo_frequency(0, 0, 1);
+	show_frequency(f_vfo[cur_vfo]);
+}
+
+void menu_a_to_b(void)
+{
+	f_vfo[0] = f_vfo[1]; //VFO A = VFO B
+}
+
+void menu_b_to_a(void)
+{
+	f_vfo[1] = f_vfo[0]; //VFO B = VFO A
+}
+
+void menu_scope(void)
+{
+	bandscope(f_vfo[cur_vfo]);
+}
+
+void menu_recall(void)
+{
+	recall_mem_freq(f_vfo[cur_vfo]);     //Recall QRG  
+}
+
+void menu_store(void)
+{
+	save_mem_freq(f_vfo[cur_vfo], last_memplace);
+}
+
+void menu_label(void)
+{
+	edit_mem_label(last_memplace);
+}
+
+void menu_prio(void)
+{
+	set_prio_mem((prio_mem == last_memplace) ? -1 : last_memplace); //Toggle
+	
+	//Message over the main display
+	lcd_cls(0, 83, 0, 47);
+	show_all_data(f_vfo[cur_vfo], sideband, voltage, last_memplace, cur_vfo, split);
+	lcd_putstring(0, 5, "              ", 0, 0);
+	lcd_putstring(0, 5, "PRIO", 0, 1);
+	if(prio_mem >= 0)
+	{
+		lcd_putnumber(30, 5, prio_mem, -1, 0, 0);
+	}
+	else
+	{
+		lcd_putstring(30, 5, "OFF", 0, 0);
+	}
+	_delay_ms(500);
+}
+
+void menu_scan_mem(void)
+{
+	int t1;
+	unsigned long freq_temp = 0;
+	
+	//Scan runs on the main display
+	lcd_cls(0, 83, 0, 47);
+	show_all_data(f_vfo[cur_vfo], sideband, voltage, last_memplace, cur_vfo, split);
+	t1 = scan(0);
+	if(t1 > -1)
+	{
+		freq_temp = load_mem_freq(t1);
+	}	
+	if(is_mem_freq_ok(freq_temp))
+	{
+		set_vfo_frequency(freq_temp, 0, 1);
+		show_frequency(f_vfo[cur_vfo]);
+	}	
+}
+
+void menu_scan_band(void)
+{
+	unsigned long freq_temp;
+	
+	//Scan runs on the main display
+	lcd_cls(0, 83, 0, 47);
+	show_all_data(f_vfo[cur_vfo], sideband, voltage, last_memplace, cur_vfo, split);
+	freq_temp = scan(1);
+	if(is_mem_freq_ok(freq_temp))
+	{
+		set_vfo_frequency(freq_temp, 0, 1);
+		show_frequency(f_vfo[cur_vfo]);
+	}	
+}
+
+void menu_scan_limits(void)
+{
+	set_scan_frequency(0, f_vfo[cur_vfo]); //Goes on to upper limit
+}
+
+void menu_split_on(void)
+{
+	split = 1;
+	if(cur_vfo == 0)
+	{
+		vfo_x = 0;
+		vfo_y = 1;
+	}	
+	else
+	{
+		vfo_x = 1;
+		vfo_y = 0;
+	}	
+	show_vfo(cur_vfo, 1);
+}
+
+void menu_split_off(void)
+{
+	split = 0;
+	show_vfo(cur_vfo, 0);
+}
+
+void menu_dw_on(void)
+{
+	dual_watch = 1;
+	eeprom_write_byte((uint8_t*)157, dual_watch);
+}
+
+void menu_dw_off(void)
+{
+	dual_watch = 0;
+	eeprom_write_byte((uint8_t*)157, dual_watch);
+}
+
+void menu_lo_usb(void)
+{
+	set_lo_freq(0);
+}
+
+void menu_lo_lsb(void)
+{
+	set_lo_freq(1);
+}
+
+void menu_lo_reset(void)
+{
+	f_lo[0] = 9001500;
+	store_frequency(f_lo[0], 35);
+	f_lo[1] = 8998500;
+	store_frequency(f_lo[1], 36);
+	set_frequency2(f_lo[sideband]);
+}
+
+  ///////////////////////
+ //  Task scheduler   //
+///////////////////////
+//First release of all timed tasks one period from now
+void task_init(void)
+{
+	int t1;
+	unsigned long now = get_clock_ms();
+	
+	for(t1 = 0; t1 < TASKS; t1++)
+	{
+		task_next[t1] = now + task_period[t1];
+		task_miss[t1] = 0;
+		task_late_max[t1] = 0;
+		task_run_max[t1] = 0;
+	}
+	
+	//Read switches once
+	post_event(EV_PIN | EV_KEY);
+}		
+
+//Run task and record its longest run time
+void task_run(int t)
+{
+	unsigned long t0 = get_clock_ticks();
+	
+	task_func[t]();
+	
+	t0 = get_clock_ticks() - t0;
+	if(t0 > 0xFFFF)
+	{
+		t0 = 0xFFFF;
+	}
+	if(t0 > task_run_max[t])
+	{
+		task_run_max[t] = t0;
+	}		
+}	
+
+//One pass of scheduler: untimed tasks with pending events, then the first timed task due.
+//A release is missed if the task starts later than one period after it.
+//Returns 1 if a timed task has run (more may be due).
+int run_tasks(void)
+{
+	int t1;
+	unsigned char ev;
+	unsigned long now, late;
+	unsigned long stamp[EV_STAMPED];
+	
+	ev = take_events(stamp);
+	for(t1 = 0; t1 < TASKS; t1++)
+	{
+		if(!task_period[t1] && (ev & task_event[t1]))
+		{
+			event_latency(ev & task_event[t1], stamp);
+			task_run(t1);
+		}
+	}
+	
+	now = get_clock_ms();
+	for(t1 = 0; t1 < TASKS; t1++)
+	{
+		if(task_period[t1] && (long) (now - task_next[t1]) >= 0)
+		{
+			late = now - task_next[t1];
+			if(late > task_late_max[t1])
+			{
+				task_late_max[t1] = (late > 0xFFFF) ? 0xFFFF : late;
+			}
+			
+			if(late >= task_period[t1])
+			{
+				task_miss[t1]++;
+				task_next[t1] = now + task_period[t1]; //Start over
+			}
+			else
+			{
+				task_next[t1] += task_period[t1];
+			}
+			
+			task_run(t1);
+			return 1;
+		}
+	}
+	
+	return 0;
+}		
+
+//Set event, first post since last take gets time stamp. ISRs and main.
+void post_event(unsigned char ev)
+{
+	int t1;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		for(t1 = 0; t1 < EV_STAMPED; t1++)
+		{
+			if((ev & (1 << t1)) && !(events & (1 << t1)))
+			{
+				ev_stamp[t1] = get_clock_ticks();
+			}
+		}
+		events |= ev;
+	}
+}		
+
+//Read and clear pending events and their time stamps
+unsigned char take_events(unsigned long *stamp)
+{
+	unsigned char ev;
+	int t1;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ev = events;
+		events = 0;
+		for(t1 = 0; t1 < EV_STAMPED; t1++)
+		{
+			stamp[t1] = ev_stamp[t1];
+		}
+	}
+	
+	return ev;
+}		
+
+//Record time from post of events to now
+void event_latency(unsigned char ev, unsigned long *stamp)
+{
+	int t1;
+	unsigned long now = get_clock_ticks();
+	
+	for(t1 = 0; t1 < EV_STAMPED; t1++)
+	{
+		if(ev & (1 << t1))
+		{
+			if(now - stamp[t1] > ev_lat_max[t1])
+			{
+				ev_lat_max[t1] = (now - stamp[t1] > 0xFFFF) ? 0xFFFF : now - stamp[t1];
+			}
+		}
+	}
+}		
+
+//Sleep in idle mode until an event is pending. ADC interrupts wake up
+//the CPU every 0.25ms, NR samples of the S-meter are taken meanwhile.
+void idle_sleep(void)
+{
+	while(!events)
+	{
+		adc_nr_sample();
+		
+		set_sleep_mode(SLEEP_MODE_IDLE);
+		cli();
+		if(!events)
+		{
+			sleep_enable();
+			sei();
+			sleep_cpu();
+			sleep_disable();
+		}
+		sei();
+	}
+}		
+
+//Max latency of events in us, key 4 resets
+void show_latency(void)
+{
+	lcd_cls(0, 83, 0, 47);
+    lcd_putstring(6, 0, " LATENCY US ", 0, 1);
+    
+    latency_step(0, 0);
+    screen_open(SCR_LATENCY);
+}		
+
+//Latency screen, redrawn on each tick. Keys 1..3 leave.
+int latency_step(int key, int steps)
+{
+	int t1;
+	
+	if(key == 4)
+	{
+		for(t1 = 0; t1 < EV_STAMPED; t1++)
+		{
+			ev_lat_max[t1] = 0;
+		}
+	}
+	else if(key)
+	{
+		return 1;
+	}
+	
+	for(t1 = 0; t1 < EV_STAMPED; t1++)
+	{
+		lcd_putstring(0, t1 + 1, "           ", 0, 0);
+		lcd_putstring(0, t1 + 1, ev_name[t1], 0, 0);
+		lcd_putnumber(30, t1 + 1, ev_lat_max[t1] * 4L, -1, 0, 0);
+	}
+	
+	return 0;
+}		
+
+//Called after IO_UD strobe of DDS1 for tuning armed by get_tuning_hz()
+void tlat_record(void)
+{
+	unsigned long dt = get_clock_ticks() - tlat_t0;
+	int b = 0;
+	
+	tlat_armed = 0;
+	while(b < TLAT_BUCKETS - 1 && (dt >> b))
+	{
+		b++;
+	}
+	if(tlat_hist[b] < 0xFFFF)
+	{
+		tlat_hist[b]++;
+	}
+	tlat_count++;
+	if(dt > tlat_max)
+	{
+		tlat_max = dt;
+	}
+}		
+
+void tlat_init(void)
+{
+	int t1;
+	
+	for(t1 = 0; t1 < TLAT_BUCKETS; t1++)
+	{
+		tlat_hist[t1] = 0;
+	}
+	tlat_count = 0;
+	tlat_max = 0;
+}		
+
+//Write histogram to EEPROM for profile.py
+void tlat_dump(void)
+{
+	eeprom_write_byte((uint8_t*)TLAT_EEP_ADR, 'T');
+	eeprom_write_byte((uint8_t*)TLAT_EEP_ADR + 1, 'L');
+	eeprom_write_byte((uint8_t*)TLAT_EEP_ADR + 2, TLAT_BUCKETS);
+	eeprom_write_byte((uint8_t*)TLAT_EEP_ADR + 3, 0);
+	eeprom_write_block(&tlat_count, (uint8_t*)TLAT_EEP_ADR + 4, sizeof(tlat_count));
+	eeprom_write_block(&tlat_max, (uint8_t*)TLAT_EEP_ADR + 8, sizeof(tlat_max));
+	eeprom_write_block(tlat_hist, (uint8_t*)TLAT_EEP_ADR + 12, sizeof(tlat_hist));
+}		
+
+//Tuning latency: count, max in us and histogram, 1 bar of 5 pixels per bucket
+//scaled to fullest bucket. Key 2 writes to EEPROM, key 4 resets.
+void show_tuning_latency(void)
+{
+	lcd_cls(0, 83, 0, 47);
+    lcd_putstring(0, 0, " TUNE LAT US  ", 0, 1);
+    
+    scr_pos = 0;
+    tuning_latency_step(0, 0);
+    screen_open(SCR_TUNLAT);
+}		
+
+//Tuning latency screen, redrawn on each tick, scr_pos counts down the ticks
+//"DUMPED" is shown. Keys 1 and 3 leave.
+int tuning_latency_step(int key, int steps)
+{
+	int t1, t2, h;
+	unsigned int top;
+	
+	switch(key)
+	{
+		case 1:
+		case 3: return 1;
+		
+		case 2: tlat_dump();
+		        scr_pos = 5;
+		        break;
+		        
+		case 4: tlat_init();
+		        break;
+	}
+	
+	lcd_putstring(0, 1, "N             ", 0, 0);
+	lcd_putnumber(18, 1, tlat_count, -1, 0, 0);
+	if(scr_pos)
+	{
+		lcd_putstring(0, 2, "DUMPED        ", 0, 0);
+		scr_pos--;
+	}
+	else
+	{
+		lcd_putstring(0, 2, "MAX           ", 0, 0);
+		lcd_putnumber(30, 2, tlat_max * 4, -1, 0, 0);
+	}
+	
+	top = 1;
+	for(t1 = 0; t1 < TLAT_BUCKETS; t1++)
+	{
+		if(tlat_hist[t1] > top)
+		{
+			top = tlat_hist[t1];
+		}
+	}		
+	
+	//Rows 3..5 = 24 pixels, LSB is top pixel of a row
+	for(t2 = 0; t2 < 3; t2++)
+	{
+		lcd_gotoxy(2, 5 - t2);
+		for(t1 = 0; t1 < TLAT_BUCKETS; t1++)
+		{
+			h = (long) tlat_hist[t1] * 24 / top;
+			if(tlat_hist[t1] && !h)
+			{
+				h = 1;
+			}
+			h -= t2 * 8;
+			if(h < 0)
+			{
+				h = 0;
+			}
+			if(h > 8)
+			{
+				h = 8;
+			}
+			lcd_senddata(0xFF << (8 - h));
+			lcd_senddata(0xFF << (8 - h));
+			lcd_senddata(0xFF << (8 - h));
+			lcd_senddata(0xFF << (8 - h));
+			lcd_senddata(0);
+		}
+	}		
+	
+	return 0;
+}		
+
+//Misses and max lateness (ms) of each task, key 4 toggles to max run time (1/10 ms)
+void show_task_stats(void)
+{
+	lcd_cls(0, 83, 0, 47);
+	
+	scr_arg = 0; //Column
+	scr_pos = 0; //First line
+	task_stats_step(0, 0);
+	screen_open(SCR_TASKS);
+}		
+
+//Task screen, redrawn on each tick. Keys 1..3 leave.
+int task_stats_step(int key, int steps)
+{
+	int t1, t2;
+	
+	if(key == 4)
+	{
+		scr_arg = !scr_arg;
+	}
+	else if(key)
+	{
+		return 1;
+	}
+	
+	scr_pos = limit_step(scr_pos, steps, 1, 0, TASKS - 5);
+	
+	if(!scr_arg)
+	{
+	    lcd_putstring(0, 0, "TASK MISS LATE", 0, 1);
+	}
+	else
+	{
+	    lcd_putstring(0, 0, "TASK  RUN     ", 0, 1);
+	}
+	    	
+	for(t1 = 0; t1 < 5; t1++)
+	{
+		t2 = scr_pos + t1;
+		lcd_putstring(0, t1 + 1, "              ", 0, 0);
+		lcd_putstring(0, t1 + 1, task_name[t2], 0, 0);
+		if(!scr_arg)
+		{
+		    lcd_putnumber(36, t1 + 1, task_miss[t2], -1, 0, 0);
+		    lcd_putnumber(60, t1 + 1, task_late_max[t2], -1, 0, 0);
+		}
+		else
+		{
+			lcd_putnumber(36, t1 + 1, task_run_max[t2] / 25, 1, 0, 0);
+		}	
+	}
+	
+	return 0;
+}		
+
+//Encoder to DDS, highest priority
+void task_tuning(void)
+{
+	long df;
+	unsigned int grid;
+	int steps;
+	
+	//Knob belongs to open screen
+	if(screen != SCR_NONE)
+	{
+		steps = get_tuning_steps();
+		if(steps)
+		{
+			screen_input(0, steps);
+		}
+		return;
+	}
+	
+	//All detents since last pass with acceleration, CW < 0 < CCW
+	df = get_tuning_hz(&grid);
+	if(df)
+	{
+		set_vfo_frequency(0, df, grid);
+        show_frequency(f_vfo[cur_vfo]);    		
+	}
+}		
+
+//TX/RX display, DDS has been switched by pin_fast_path()
+void task_txrx(void)
+{
+	static int txrx_old = 0;
+			
+	if(txrx_old != txrx) //PTT switched
+	{
+	    txrx_old = txrx;
+	    
+	    //Send SPLIT frequency again in case main has overwritten the fast path
+	    if(split)
+	    {
+		    set_vfo_frequency(0, 0, 1);
+		}
+		
+		//Display is redrawn when the screen closes
+		if(screen != SCR_NONE)
+		{
+			return;
+		}
+		
+	    show_meter_scale(txrx);
+	    show_meter(0);
+	    
+	    //Show frequency if SPLIT activated
+	    if(split)
+	    {
+		    show_vfo(cur_vfo, split);
+		    show_frequency(f_vfo[cur_vfo]);    
+		}
+	}
+}		
+
+//Keys and menu
+void task_keys(void)
+{
+	int key;
+	
+	//Keys belong to open screen, with repeats of a held key
+	if(screen != SCR_NONE)
+	{
+		key = get_key_input(KEY_EV_PRESS | KEY_EV_REPEAT);
+		if(key)
+		{
+			screen_input(key, 0);
+		}
+		key = 0;
+	}
+	else
+	{
+		key = get_key_press();
+	}
+	
+	switch(key)
+	{
+		case 1: flush_key_events();
+		        menux();                 //Menu screen runs the chosen action
+				break;
+				
+		case 2: store_last_vfo(cur_vfo);
+		        store_frequency(f_vfo[0], 16); //VFO A
+		        store_frequency(f_vfo[1], 17); //VFO B
+		        store_last_mem(last_memplace);
+		        break;
+		        
+		case 4: //Swap VFOs
+		
+		        //Store values
+		        store_frequency(f_vfo[0], 16); //VFO A
+		        store_frequency(f_vfo[1], 17); //VFO B
+		        if(cur_vfo)
+		        {
+		            cur_vfo = 0;
+		        }
+		        else
+		        {
+		            cur_vfo = 1;
+		        }
+		       
+		        show_vfo(cur_vfo, split);
+		        set_vfo_frequency(0, 0, 1);
+		        show_frequency(f_vfo[cur_vfo]);
+		        store_last_vfo(cur_vfo);
+		        key = 0;
+		        break;
+	}
+	
+	//More events queued meanwhile
+	if(key_q_head != key_q_tail)
+	{
+		post_event(EV_KEY);
+	}	
+}		
+
+//Ticks of open screen with live data
+void task_screen(void)
+{
+	if(screen != SCR_NONE && screen_tick[screen] && clock_due(&scr_t, screen_tick[screen]))
+	{
+		screen_input(0, 0);
+	}
+}		
+
+//Sideband display, DDS has been switched by pin_fast_path()
+void task_sideband(void)
+{
+	static int sideband_old = 0;
+	
+	if(sideband_old != sideband)
+	{
+		set_vfo_frequency(0, 0, 1);    		 
+	    set_frequency2(f_lo[sideband]);
+		sideband_old = sideband;
+		if(screen == SCR_NONE)
+		{
+	        show_frequency(f_vfo[cur_vfo]);    		
+			show_sideband(sideband, 0);
+		}
+	}
+}		
+
+//S-Val resp. PWR value
+void task_meter(void)
+{
+	if(screen != SCR_NONE)
+	{
+		return;
+	}
+	
+	if(!txrx)
+ 	{
+		show_meter(get_meter(2)); //S-Meter * 1
+ 	}
+ 	else
+ 	{
+		show_meter((get_meter(3) >> 1)); //*0.5
+	}    
+}		
+
+//Delete max value of meter after 2 seconds
+void task_smax(void)
+{
+	if(screen == SCR_NONE && clock_since(time_smax) > 2000)
+	{
+		reset_smax();
+		show_meter(get_meter(2));			
+	}	
+}		
+
+//Alive indicator
+void task_blink(void)
+{
+	static char blink = '.';
+	
+	blink = (blink == '.') ? '*' : '.';
+	if(screen == SCR_NONE)
+	{
+		lcd_putchar1(13 * 6, 4, blink, 0);
+	}
+}		
+
+void task_volt(void)
+{
+	static int volts1_old = 0;
+	
+	measure_voltage();
+    if(voltage != volts1_old && screen == SCR_NONE)
+    {
+        show_voltage(voltage);
+ 		volts1_old = voltage;
+    }	
+}		
+
+void task_patemp(void)
+{
+	static int pa_temp_old = 0;
+	int pa_temp;
+	
+	pa_temp = get_temp();
+	if(pa_temp != pa_temp_old && screen == SCR_NONE)
+	{
+        show_pa_temp(pa_temp);
+        pa_temp_old = pa_temp;
+    }    
+}		
+
+//Store VFO data
+void task_autosave(void)
+{
+	store_vfo_data(cur_vfo, f_vfo[0], f_vfo[1]);
+	if(screen == SCR_NONE)
+	{
+		lcd_putchar1(13 * 6, 1, '.', 0);
+	}
+}		
+
+//Dual watch, looks at the other VFO while the current one is quiet and switches over if it is busy
+void task_dualwatch(void)
+{
+	int other = !cur_vfo;
+	int sval, peek;
+	
+	if(!dual_watch || txrx || split || screen != SCR_NONE || get_meter(2) > s_threshold)
+	{
+		return;
+	}
+	
+	//A PTT change meanwhile clears dds_peek and takes DDS1 home, the S-value is void then
+	dds_peek = 1;
+	sval = look_at(ftw_cached(other, f_vfo[other]));
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		peek = dds_peek;
+		if(peek && sval > s_threshold)
+		{
+			cur_vfo = other; //DDS1 is there already
+			dds_peek = 0;
+		}
+	}
+	
+	if(cur_vfo == other)
+	{
+		show_vfo(cur_vfo, 0);
+		show_frequency(f_vfo[cur_vfo]);
+	}
+	else
+	{
+		if(peek)
+		{
+			dds1_hop(ftw_cached(cur_vfo, f_vfo[cur_vfo]));
+		}
+		dds_peek = 0; //Only now, a PTT change during the hop home sends home again
+		meter_restart(0); //Samples of the other VFO stay out of the home block
+	}
+}		
+
+  ///////////////////////
+ //     Profiling     //
+///////////////////////
+#ifdef PROFILE
+//Account one call of function n that started at clock tick t0
+void prof_record(int n, unsigned long t0)
+{
+	unsigned long t = get_clock_ticks() - t0;
+	
+	prof_calls[n]++;
+	prof_total[n] += t;
+	if(t > prof_max[n])
+	{
+		prof_max[n] = t;
+	}	
+}		
+#endif
+
+//Clear tables
+void prof_init(void)
+{
+#ifdef PROFILE
+	int t1;
+	
+	for(t1 = 0; t1 < PROF_FUNCS; t1++)
+	{
+		prof_calls[t1] = 0;
+		prof_total[t1] = 0;
+		prof_max[t1] = 0;
+	}
+#endif
+}		
+
+//Write tables to EEPROM for profile.py
+void prof_dump(void)
+{
+#ifdef PROFILE
+	eeprom_write_byte((uint8_t*)PROF_EEP_ADR, 'P');
+	eeprom_write_byte((uint8_t*)PROF_EEP_ADR + 1, 'F');
+	eeprom_write_byte((uint8_t*)PROF_EEP_ADR + 2, PROF_FUNCS);
+	eeprom_write_byte((uint8_t*)PROF_EEP_ADR + 3, PROF_TICK_CYCLES);
+	eeprom_write_block(prof_calls, (uint8_t*)PROF_EEP_ADR + 4, sizeof(prof_calls));
+	eeprom_write_block(prof_total, (uint8_t*)PROF_EEP_ADR + 4 + sizeof(prof_calls), sizeof(prof_total));
+	eeprom_write_block(prof_max, (uint8_t*)PROF_EEP_ADR + 4 + sizeof(prof_calls) + sizeof(prof_total), sizeof(prof_max));
+#endif
+}		
+
+//Functions ranked by total time, one per page: calls, average and max in us.
+//Key 2 writes tables to EEPROM, key 4 clears them.
+void show_profile(void)
+{
+	lcd_cls(0, 83, 0, 47);
+#ifdef PROFILE
+	scr_pos = 0; //Page
+	profile_step(0, 0);
+#else
+	lcd_putstring(0, 1, "NO PROFILING", 0, 0);
+	lcd_putstring(0, 2, "MAKE PROFILE=1", 0, 0);
+#endif
+	screen_open(SCR_PROFILE);
+}		
+
+//Profile screen, keys 1 and 3 leave (any key without PROFILE)
+int profile_step(int key, int steps)
+{
+#ifdef PROFILE
+	int t1, t2, x;
+	unsigned char rank[PROF_FUNCS];
+	
+	switch(key)
+	{
+		case 1:
+		case 3: return 1;
+		
+		case 2: prof_dump();
+		        lcd_putstring(0, 5, "DUMPED", 0, 1);
+		        return 0;
+		        
+		case 4: prof_init();
+		        break;
+	}
+	
+	scr_pos = wrap_step(scr_pos, steps, PROF_FUNCS - 1);
+	
+	//Sort by total
+	for(t1 = 0; t1 < PROF_FUNCS; t1++)
+	{
+		rank[t1] = t1;
+	}
+	for(t1 = 1; t1 < PROF_FUNCS; t1++)
+	{
+		for(t2 = t1; t2 > 0 && prof_total[rank[t2]] > prof_total[rank[t2 - 1]]; t2--)
+		{
+			x = rank[t2];
+			rank[t2] = rank[t2 - 1];
+			rank[t2 - 1] = x;
+		}	
+	}
+	
+	x = rank[scr_pos];
+	lcd_cls(0, 83, 0, 47);
+	lcd_putnumber(0, 0, scr_pos + 1, -1, 0, 1);
+	lcd_putstring(12, 0, prof_name[x], 0, 0);
+	lcd_putstring(0, 2, "CALLS", 0, 0);
+	lcd_putnumber(36, 2, prof_calls[x], -1, 0, 0);
+	lcd_putstring(0, 3, "AVG US", 0, 0);
+	if(prof_calls[x])
+	{
+	    lcd_putnumber(42, 3, prof_total[x] * 4 / prof_calls[x], -1, 0, 0);
+	}    
+	lcd_putstring(0, 4, "MAX US", 0, 0);
+	lcd_putnumber(42, 4, prof_max[x] * 4, -1, 0, 0);
+	
+	return 0;
+#else
+	return key != 0;
+#endif
+}		
+
+#ifdef BENCH
+//Each function BENCH_REPEAT times with interrupts off, then stop the simulation
+void bench_run(void)
+{
+	char buf[12];
+	int t1;
+	
+	hal_irq_sources_off();
+	for(t1 = 0; t1 < BENCH_REPEAT; t1++)
+	{
+		BENCH_RUN(BENCH_EMPTY, );
+		BENCH_RUN(BENCH_SET_FREQUENCY1, set_frequency1(14200000));
+		BENCH_RUN(BENCH_SET_FREQUENCY2, set_frequency2(f_lo[0]));
+		BENCH_RUN(BENCH_SHOW_FREQUENCY, show_frequency(14123456));
+		BENCH_RUN(BENCH_SHOW_METER, show_meter(40));
+		BENCH_RUN(BENCH_LCD_CLS, lcd_cls(0, 83, 0, 47));
+		BENCH_RUN(BENCH_INT2ASC, int2asc(14123456, 3, buf, sizeof(buf)));
+		BENCH_RUN(BENCH_STORE_FREQUENCY, store_frequency(14123456, 16));
+		BENCH_RUN(BENCH_GET_TEMP, get_temp());
+		BENCH_RUN(BENCH_SHOW_ALL_DATA, show_all_data(14123456, 0, 138, 0, 0, 0));
+	}
+	hal_bench_mark(BENCH_MARK_END);
+	
+	cli();
+	sleep_enable();
+	sleep_cpu();
+}	
+#endif
+
+  //////////
+ // MAIN //
+//////////
+int main(void)
+{
+	//Universal counter(s)
+	int t1; 
+	
+    //DDS 1          
+    //Set DDRB of DDSPort1 and DDS Resetport  
+	hal_port_write(DDRB, 0x0F); //SPI-Lines + RESET line on PB0..PB3
+	
+	//DDS 2
+    hal_port_write(DDRC, 0x0F);
+    
+	//Set DDR of LCDPort
+	hal_port_write(DDRD, 0xF0); //PD0..PD3: Display lines: CLK DIN DC RST
+    
+    //Input (analog & digital)
+    hal_port_write(PORTA, 0x01); //Pull-up resistor for key recognition on PA0
+
+    //PORTD pullup
+    hal_port_write(PORTD, (1 << PD1)); //Sideband switch detection
+    
+	//Interrupt definitions for rotary encoder attached to PD2 and PD3
+	enc_state = (hal_port_in(PIND) & 0x0C) >> 2;
+	hal_enc_init();   // Trigger INT0 and INT1 on pin change
+	//PTT and sideband switch
+	pin_init();
+	
+    //Timer 1 as ms clock
+    hal_clock_init(CLOCK_TOP); // Prescaler = /64 based on system clock 16MHz => 250 inc per ms
+	
+	//ADC sequencer, let it fill all channel slots once
+	adc_init();
+	sei();
+	_delay_ms(3);
+	
+	//INIT LCD
+	lcd_init();
+
+	//Reset DDS1 (AD9951)
+	hal_port_clr(DDS1_PORT, (1 << DDS1_RESETPIN));          
+    _delay_ms(1);
+	hal_port_set(DDS1_PORT, (1 << DDS1_RESETPIN));     
+       
+    //Reset DDS2 (AD9834)	
+	_delay_ms(10);	
+	hal_port_set(DDS2_PORT, (1 << DDS2_RESETPIN));   //Bit set
+    _delay_ms(10);       
+	hal_port_clr(DDS2_PORT, (1 << DDS2_RESETPIN));  //Bit erase        
+	_delay_ms(10);	
+
+    //Load scan threshold
+    s_threshold = eeprom_read_byte((uint8_t*)129);          	
+    if(s_threshold < 0 || s_threshold > 80)
+    {
+		s_threshold = 30;
+	}
+	
+	//Load scan edge frequencies
+	scanfreq[0] = load_frequency(33);
+	if(!is_mem_freq_ok(scanfreq[0]))
+	{
+		scanfreq[0] = 14100000;
+	}	
+	scanfreq[1] = load_frequency(34);
+	if(!is_mem_freq_ok(scanfreq[1]))
+	{
+		scanfreq[1] = 14300000;
+	}
+		
+    //Load last stored freqeuncy
+    //Check if memory place is not a random number anywhere in EEPROM
+    last_memplace = load_last_mem();
+    if(last_memplace < 0 || last_memplace > MAXMEM)
+    {
+		last_memplace = 0;
+	}
+	
+	//Memory bank and its frequency index
+	init_mem_bank();
+	build_mem_index();
+	
+	if(is_mem_freq_ok(load_mem_freq(last_memplace)))
+	{
+		show_mem_freq(load_mem_freq(last_memplace), 0);
+	}
+	else
+	{	
+		show_mem_freq(0, 0);	
+	}	
+	
+	//Load LO frequencies set by user
+	for(t1 = 0; t1 < 2; t1++)
+	{
+		f_lo[t1] = load_frequency(35 + t1);
+		if(f_lo[t1] < 8995000 || f_lo[t1] > 9005000)
+		{
+			switch(t1)
+			{
+				case 0: f_lo[t1] = 9001500; //USB
+				         break;
+				case 1: f_lo[t1] = 8998500; //LSB
+				         break;        
+			}
+		}
+	}			          
+				
+	//Load VFO data
+	//Set VFO 
+    cur_vfo = load_last_vfo();
+    if(cur_vfo < 0 || cur_vfo > 1)
+    {
+		cur_vfo = 0;
+	}
+	for(t1 = 0; t1 < 2; t1++)    
+	{
+        f_vfo[t1] = load_frequency(16 + t1);
+
+        //Check if freq is in 20m band
+        if(!is_mem_freq_ok(f_vfo[t1]))
+        {
+		    f_vfo[t1] = 14220000;
+		    store_frequency(f_vfo[t1], 16 + t1);
+		}    
+    }
+    //Set this frequency
+    set_vfo_frequency(0, 0, 1);
+        
+    //Set LO
+    set_frequency2(f_lo[sideband]); 
+    set_frequency2(f_lo[sideband]); 
+    set_frequency2(f_lo[sideband]); 
+    
+    //Initial voltage measurement
+    volt_cal = eeprom_read_word((uint16_t*)148);
+    if(volt_cal < 3000 || volt_cal > 6000)
+    {
+		volt_cal = VOLTAGEFACTOR;
+	}
+	volt_alarm = eeprom_read_byte((uint8_t*)150);
+	if(volt_alarm < 50 || volt_alarm > 200)
+	{
+		volt_alarm = 110;
+	}	
+    measure_voltage();
+    
+    //S-meter sampling mode
+    adc_nr_mode = eeprom_read_byte((uint8_t*)151) == 1;
+    
+    //Tuning acceleration curve
+    tune_accel = eeprom_read_byte((uint8_t*)152);
+    if(tune_accel >= ACCEL_CURVES)
+    {
+		tune_accel = 1;
+	}	
+	
+	//Band scan step and resume policy
+	scan_step = eeprom_read_byte((uint8_t*)153);
+	if(scan_step >= SCAN_STEPS)
+	{
+		scan_step = 0;
+	}
+	scan_resume = eeprom_read_byte((uint8_t*)154);
+	if(scan_resume >= SCAN_RESUMES)
+	{
+		scan_resume = SCAN_RESUME_CARRIER;
+	}
+	hitlog_eep = eeprom_read_byte((uint8_t*)155) == 1;
+	hitlog_load();
+	excl_load();
+	
+	//Priority channel and dual watch
+	t1 = eeprom_read_byte((uint8_t*)156);
+	if(t1 <= MAXMEM && is_mem_freq_ok(load_mem_freq(t1)))
+	{
+		prio_mem = t1;
+		prio_f = load_mem_freq(t1);
+	}
+	dual_watch = eeprom_read_byte((uint8_t*)157) == 1;
+	
+	//Fill lcd with all available information 
+    show_all_data(f_vfo[cur_vfo], sideband, voltage, last_memplace, cur_vfo, split);
+        
+#ifdef BENCH
+    bench_run();
+#endif
+	sei();
+	
+	prof_init();
+	task_init();
+    
+    for(;;) 
+	{
+		//S-meter sample in NR sleep mode while all buses are quiet
+		adc_nr_sample();
+		
+		if(!run_tasks())
+		{
+			idle_sleep();
+		}	
+    }
+    return 0;
+}
@@ -0,0 +1,176 @@
+#!/usr/bin/env python
+# Ranked report of the function profile of a PROFILE=1 build of the Mini22.
+#
+# The tables (calls, total and max run time in clock ticks of 4us) are
+# read either from the EEPROM, after INFO/PROFIL key 2 has dumped them,
+# or from a RAM image, e.g. taken in simavr/avr-gdb with
+#   dump binary memory ram.bin 0x800100 0x801100
+#
+# The tuning latency histogram (INFO/TUNLAT key 2) and the scan hit log
+# (SCAN/CONFIG LOG EEP) are printed as well if the EEPROM holds them,
+# they are recorded in every build.
+#
+# Usage: python profile.py eeprom.eep           (avrdude dump, raw or ihex)
+#        python profile.py --ram ram.bin --elf mini22.elf [--ram-base 0x100]
+#
+# Function names and EEPROM address are taken from mini22.c.
+#
+# A call counts the clock tick edges it spans, so max is good to one tick
+# (64 cycles) and only the average over many calls resolves less.
+import re
+import struct
+import subprocess
+import sys
+
+SOURCE = "mini22.c"
+TICK_CYCLES = 64     # Timer1 prescaler, 16MHz
+F_CPU = 16000000.0
+
+
+def read_source():
+    src = open(SOURCE).read()
+    m = re.search(r"prof_name\[PROF_FUNCS\]\s*=\s*\{([^}]*)\}", src)
+    names = re.findall(r'"([^"]*)"', m.group(1))
+    adr = int(re.search(r"#define PROF_EEP_ADR\s+(\d+)", src).group(1))
+    tlat_adr = int(re.search(r"#define TLAT_EEP_ADR\s+(\d+)", src).group(1))
+    hit_adr = int(re.search(r"#define HITLOG_EEP_ADR\s+(\d+)", src).group(1))
+    hit_len = int(re.search(r"#define HITLOG_EEP_LEN\s+(\d+)", src).group(1))
+    return names, adr, tlat_adr, (hit_adr, hit_len)
+
+
+def read_image(fname):
+    # Intel hex or raw binary
+    data = open(fname, "rb").read()
+    if not data.startswith(b":"):
+        return bytearray(data)
+    image = bytearray(b"\xff" * 65536)
+    base = 0
+    for line in data.decode("ascii").split():
+        rec = bytearray.fromhex(line[1:])
+        n, adr, typ = rec[0], (rec[1] << 8) | rec[2], rec[3]
+        if typ == 0:
+            image[base + adr:base + adr + n] = rec[4:4 + n]
+        elif typ == 2:
+            base = ((rec[4] << 8) | rec[5]) << 4
+        elif typ == 4:
+            base = ((rec[4] << 8) | rec[5]) << 16
+    return image
+
+
+def from_eeprom(image, names, adr):
+    n = len(names)
+    if image[adr:adr + 2] != bytearray(b"PF") or image[adr + 2] != n:
+        return None, 0
+    tick = image[adr + 3]
+    if tick != TICK_CYCLES:
+        sys.stderr.write("Profile dump of an older build skipped\n")
+        return None, 0
+    pos = adr + 4
+    tables = []
+    for t in range(3):
+        tables.append(struct.unpack("<%dL" % n, bytes(image[pos:pos + 4 * n])))
+        pos += 4 * n
+    return tables, tick
+
+
+def from_ram(fname, elf, base, names):
+    image = read_image(fname)
+    out = subprocess.check_output(["avr-nm", elf]).decode()
+    sym = {}
+    for line in out.splitlines():
+        f = line.split()
+        if len(f) == 3:
+            sym[f[2]] = int(f[0], 16) & 0xFFFF
+    n = len(names)
+    tables = []
+    for name in ("prof_calls", "prof_total", "prof_max"):
+        pos = sym[name] - base
+        tables.append(struct.unpack("<%dL" % n, bytes(image[pos:pos + 4 * n])))
+    return tables, TICK_CYCLES
+
+
+def tlat_from_eeprom(image, adr):
+    if image[adr:adr + 2] != bytearray(b"TL"):
+        return None
+    n = image[adr + 2]
+    count, tmax = struct.unpack("<2L", bytes(image[adr + 4:adr + 12]))
+    hist = struct.unpack("<%dH" % n, bytes(image[adr + 12:adr + 12 + 2 * n]))
+    return count, tmax, hist
+
+
+def tlat_report(count, tmax, hist):
+    us = TICK_CYCLES * 1e6 / F_CPU
+    top = float(max(hist)) or 1.0
+    print("Tuning latency, detent to DDS1 update: %d updates, max %.0f us" % (count, tmax * us))
+    print("%10s %8s" % ("< us", "count"))
+    for b, c in enumerate(hist):
+        limit = "%10.0f" % ((1 << b) * us) if b < len(hist) - 1 else "%10s" % "more"
+        print("%s %8d  %s" % (limit, c, "#" * int(round(40 * c / top))))
+
+
+def hitlog_from_eeprom(image, adr, length):
+    # 'H', 'L', next record, records in use, records of f, t, dwell, S
+    if image[adr:adr + 2] != bytearray(b"HL"):
+        return None
+    pos, n = image[adr + 2], image[adr + 3]
+    hits = []
+    for i in range(n):
+        rec = adr + 4 + ((pos - n + i) % length) * 11
+        hits.append(struct.unpack("<LLHB", bytes(image[rec:rec + 11])))
+    return hits
+
+
+def hitlog_report(hits):
+    # Oldest first, times in 1/10 s since the power on they were recorded in
+    print("Scan hit log: %d stops" % len(hits))
+    print("%12s %10s %8s %6s" % ("time s", "kHz", "dwell s", "S"))
+    for f, t, dwell, s in hits:
+        print("%12.1f %10.1f %8.1f %6d" % (t / 10.0, f / 1000.0, dwell / 10.0, s))
+
+
+def report(names, tables, tick):
+    calls, total, tmax = tables
+    us = tick * 1e6 / F_CPU
+    sum_total = float(sum(total)) or 1.0
+    print("Clock ticks of %d cycles (%.0f us), max +-1 tick" % (tick, us))
+    print("%-16s %9s %12s %6s %10s %9s %9s" % ("function", "calls", "total ticks",
+                                              "%", "avg ticks", "avg us", "max us"))
+    for i in sorted(range(len(names)), key=lambda i: -total[i]):
+        avg = total[i] / float(calls[i]) if calls[i] else 0.0
+        print("%-16s %9d %12d %6.1f %10.2f %9.1f %9.0f" % (
+            names[i], calls[i], total[i],
+            100.0 * total[i] / sum_total, avg, avg * us,
+            tmax[i] * us))
+
+
+def main(args):
+    names, adr, tlat_adr, hit_adr = read_source()
+    tlat = None
+    hits = None
+    if args and args[0] == "--ram":
+        opts = dict(zip(args[2::2], args[3::2]))
+        base = int(opts.get("--ram-base", "0x100"), 0)
+        tables, tick = from_ram(args[1], opts["--elf"], base, names)
+    elif len(args) == 1:
+        image = read_image(args[0])
+        tables, tick = from_eeprom(image, names, adr)
+        tlat = tlat_from_eeprom(image, tlat_adr)
+        hits = hitlog_from_eeprom(image, *hit_adr)
+        if tables is None and tlat is None and hits is None:
+            sys.exit("No profile, tuning latency or hit log in EEPROM")
+    else:
+        sys.exit("usage: python profile.py eeprom.eep | --ram ram.bin --elf mini22.elf")
+    if tables is not None:
+        report(names, tables, tick)
+    if tlat is not None:
+        if tables is not None:
+            print("")
+        tlat_report(*tlat)
+    if hits is not None:
+        if tables is not None or tlat is not None:
+            print("")
+        hitlog_report(hits)
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])